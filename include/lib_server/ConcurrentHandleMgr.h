@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief The ConcurrentHandleMgr manages lists of handles shared by threads
+ *
+ * This is a variant of the HandleMgr for servers which process requests in
+ * multiple threads. Validating a handle is lock-free and never blocks: every
+ * slot holds a single word which is read atomically, so a concurrent
+ * validate() sees a handle either before or after an add()/remove(), but
+ * never a partial update. Only add() and remove() are serialized, either via
+ * lock callbacks provided by the user or via an internal spinlock.
+ *
+ * Handles can also be acquired for the duration of a request. As long as a
+ * handle holds references, remove() only hides it from validate()/acquire()
+ * and the release callback is called by whoever drops the last reference.
+ */
+
+#pragma once
+
+#include "OS_Error.h"
+#include "lib_server/HandleMgr.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Slot of a handle; needs to be public so users can size their buffers.
+ */
+typedef struct
+{
+    uintptr_t handle;
+    uint32_t refs;
+} ConcurrentHandleMgr_Slot_t;
+
+/**
+ * These functions will be called by the ConcurrentHandleMgr to serialize
+ * writers, e.g., the lock/unlock functions of a CAmkES mutex.
+ */
+typedef struct
+{
+    void (*lock)(void);
+    void (*unlock)(void);
+} ConcurrentHandleMgr_LockFuncs_t;
+
+/**
+ * This function will be called by the ConcurrentHandleMgr once a removed
+ * handle is no longer referenced, so the object behind it can be free'd. It
+ * is called with the writers lock held, so it must not call back into the
+ * ConcurrentHandleMgr.
+ */
+typedef void (*ConcurrentHandleMgr_ReleaseFunc_t)(
+    HandleMgr_Handle_t handle);
+
+typedef struct ConcurrentHandleMgr
+{
+    ConcurrentHandleMgr_Slot_t* slots;
+    size_t capacity;
+    size_t used;
+    bool spinlock;
+    ConcurrentHandleMgr_LockFuncs_t lockFns;
+    ConcurrentHandleMgr_ReleaseFunc_t releaseFn;
+}
+ConcurrentHandleMgr_t;
+
+#define ConcurrentHandleMgr_SIZE_OF_BUFFER(numItems)\
+    (sizeof(ConcurrentHandleMgr_Slot_t) * (numItems))
+
+/**
+ * @brief Initialize a concurrent handle manager instance
+ *
+ * Initialize a concurrent handle manager instance on a memory buffer, to
+ * which handles can be added/removed.
+ *
+ * @param self (required) pointer to handle manager
+ * @param buffer (required) memory buffer to store handles
+ * @param bufSize (required) size of memory buffer to store handles
+ * @param capacityNumHandles capacity in number of elements. This is an
+ * input/output parameter. If NULL then it is simply ignored, otherwise the
+ * init will check the required number of elements against the size of the
+ * memory buffer. If the memory is not sufficient then
+ * OS_ERROR_INSUFFICIENT_SPACE will be returned otherwise the maximum capacity
+ * of the buffer will be returned.
+ * @param lockFns (optional) callbacks to serialize add() and remove(); if NULL
+ * an internal spinlock is used
+ * @param releaseFn (optional) callback to be called when a removed handle is
+ * no longer referenced
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the required amount of handles results
+ * in a greater need of memory (than the one passed).
+ */
+OS_Error_t
+ConcurrentHandleMgr_init(
+    ConcurrentHandleMgr_t*                 self,
+    void*                                  buffer,
+    size_t                                 bufSize,
+    size_t*                                capacityNumHandles,
+    const ConcurrentHandleMgr_LockFuncs_t* lockFns,
+    ConcurrentHandleMgr_ReleaseFunc_t      releaseFn);
+
+/**
+ * @brief Free a concurrent handle manager instance
+ *
+ * Must not be called while other threads still use the handle manager.
+ *
+ * @param self (required) handle manager
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ */
+OS_Error_t
+ConcurrentHandleMgr_free(
+    ConcurrentHandleMgr_t* self);
+
+/**
+ * @brief Add handle to manager
+ *
+ * @param self (required) handle manager
+ * @param handle (required) handle
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_OPERATION_DENIED handle is duplicated
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if there is no free slot left
+ */
+OS_Error_t
+ConcurrentHandleMgr_add(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle);
+
+/**
+ * @brief (Conditionally) Add handle to manager
+ *
+ * Works like HandleMgr_addOnSuccess(), see there for details.
+ *
+ * @param self (required) handle manager
+ * @param ret (required) error code of outer function
+ * @param handle (required) pointer to handle
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_OPERATION_DENIED handle is duplicated
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if there is no free slot left
+ */
+__attribute__((unused))
+static OS_Error_t
+ConcurrentHandleMgr_addOnSuccess(
+    ConcurrentHandleMgr_t* self,
+    const OS_Error_t       ret,
+    HandleMgr_Handle_t*    handle)
+{
+    return (NULL == handle)    ? OS_ERROR_INVALID_PARAMETER :
+           (OS_SUCCESS == ret) ? ConcurrentHandleMgr_add(self, *handle) : ret;
+}
+
+/**
+ * @brief Remove handle from manager
+ *
+ * After this call the handle will no longer be validated or acquired. If the
+ * handle is not referenced, it is released right away, otherwise releasing
+ * is deferred until the last reference is dropped via release(). In both
+ * cases the release callback is called exactly once.
+ *
+ * @param self (required) handle manager
+ * @param handle (required) handle
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_HANDLE if the handle is not known
+ */
+OS_Error_t
+ConcurrentHandleMgr_remove(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle);
+
+/**
+ * @brief (Conditionally) Remove handle from manager
+ *
+ * Works like HandleMgr_removeOnSuccess(), see there for details.
+ *
+ * @param self (required) handle manager
+ * @param ret (required) error code of outer function
+ * @param handle (required) handle
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_HANDLE if the handle is not known
+ * @retval \p ret in case if \p ret != OS_SUCCESS
+ */
+__attribute__((unused))
+static OS_Error_t
+ConcurrentHandleMgr_removeOnSuccess(
+    ConcurrentHandleMgr_t* self,
+    const OS_Error_t       ret,
+    HandleMgr_Handle_t     handle)
+{
+    return ret != OS_SUCCESS ? ret : ConcurrentHandleMgr_remove(self, handle);
+}
+
+/**
+ * @brief Validate handle
+ *
+ * This function is lock-free and can be called from any number of threads in
+ * parallel to each other and to add()/remove(). If the handle is known, the
+ * handle is simply returned, otherwise this function returns NULL.
+ *
+ * Note that the handle may be removed by another thread right after it was
+ * validated; use acquire() if the object a handle refers to must not be
+ * free'd while it is still in use.
+ *
+ * @param self (required) handle manager
+ * @param handle (required) handle
+ *
+ * @return return \p handle if handle is known, NULL otherwise
+ */
+HandleMgr_Handle_t
+ConcurrentHandleMgr_validate(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle);
+
+/**
+ * @brief Acquire a reference to a handle
+ *
+ * This function works like validate(), but additionally takes a reference on
+ * the handle, so it is guaranteed not to be released while it is in use, even
+ * if another thread removes it in the meantime. Like validate(), this function
+ * is lock-free. Every successful acquire() must be paired with a release().
+ *
+ * @param self (required) handle manager
+ * @param handle (required) handle
+ *
+ * @return return \p handle if handle is known, NULL otherwise
+ */
+HandleMgr_Handle_t
+ConcurrentHandleMgr_acquire(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle);
+
+/**
+ * @brief Release a reference to a handle
+ *
+ * Drop a reference taken with acquire(). If the handle was removed in the
+ * meantime and this was the last reference, the release callback is called
+ * from within this function.
+ *
+ * @param self (required) handle manager
+ * @param handle (required) handle
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_HANDLE if the handle is not known
+ * @retval OS_ERROR_INVALID_STATE if the handle holds no acquired reference
+ */
+OS_Error_t
+ConcurrentHandleMgr_release(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle);
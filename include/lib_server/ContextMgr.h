@@ -19,6 +19,9 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+// Number of slots per bucket of a context manager with bounded lookup time
+#define ContextMgr_BUCKET_SIZE 8
+
 // Forward declaration
 typedef struct ContextMgr_ClientSlot ContextMgr_ClientSlot_t;
 
@@ -46,6 +49,9 @@ typedef struct
 typedef struct
 {
     size_t max;
+    size_t numSlots;
+    size_t numBuckets;
+    size_t used;
     ContextMgr_ClientSlot_t* slots;
     ContextMgr_MemoryFuncs_t memFns;
 } ContextMgr_t;
@@ -73,6 +79,36 @@ ContextMgr_init(
                                                         expected */
 );
 
+/**
+ * @brief Initialize a context manager instance with bounded lookup time
+ *
+ * Works like ContextMgr_init(), but the slots are organized as a hash table of
+ * small buckets, where each CID may go into one of two buckets. This way get()
+ * looks at no more than 2 * ContextMgr_BUCKET_SIZE slots and free() at all
+ * slots once, independent of how many clients there are; the table is never
+ * resized or rehashed. This is meant for real-time servers which need a bound
+ * on the worst case of every RPC.
+ *
+ * Twice as many slots as \p max are allocated, so buckets are at most half
+ * full. As CIDs are typically fixed when a system is built, whether a set of
+ * clients fits into the table is known up front; get() fails for a new CID if
+ * both of its buckets are full.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the slots could not be allocated
+ */
+OS_Error_t
+ContextMgr_initBounded(
+    ContextMgr_t*                   self,   /**< [in]   pointer to context
+                                                        manager */
+    const ContextMgr_MemoryFuncs_t* memFns, /**< [in]   client context alloc/free
+                                                        callbacks */
+    const size_t                    max     /**< [in]   maximum amount of contexts
+                                                        expected */
+);
+
 /**
  * @brief Free a context manager instance
  *
@@ -105,7 +141,8 @@ ContextMgr_free(
  * @retval OS_SUCCESS if operation succeeded
  * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
  * @retval OS_ERROR_INSUFFICIENT_SPACE if there is no slot assigned to the
- *  \p CID but there are no more free slots left.
+ *  \p CID but there are no more free slots left (or, if initialized with
+ *  ContextMgr_initBounded(), no free slot in both buckets of the \p CID).
  */
 OS_Error_t
 ContextMgr_get(
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief Header-only C++ variant of the ContextMgr with compile-time capacity
+ *
+ * The ContextTable implements the same algorithm as the ContextMgr, but
+ * client contexts are stored inline and constructed in place, instead of
+ * being allocated through ContextMgr_MemoryFuncs_t callbacks. A context is
+ * constructed from the CID if it opts in with a constructor
+ * Ctx(lib_server::WithCid, ContextMgr_CID_t), otherwise it is
+ * default-constructed; it is destroyed along with the table.
+ */
+
+#pragma once
+
+extern "C"
+{
+#include "lib_server/ContextMgr.h"
+}
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+namespace lib_server
+{
+
+/**
+ * Tag for the constructor of a client context which takes the CID; without
+ * it, any constructor taking an integer (e.g., the size of a container) would
+ * be called with the CID
+ */
+struct WithCid
+{
+    explicit WithCid() = default;
+};
+
+template <typename Ctx, std::size_t N>
+class ContextTable
+{
+    // Same limits as for the ContextMgr
+    static_assert(N >= 1 && N <= 1024,
+                  "ContextTable supports between 1-1024 contexts");
+
+public:
+    /**
+     * Maximum number of client contexts which can be stored
+     */
+    static constexpr std::size_t capacity = N;
+
+    /**
+     * @brief Get a client context based on its ID
+     *
+     * If there is no context for that CID yet, it is constructed in the next
+     * free slot.
+     *
+     * @return pointer to the client context, or nullptr if there is no slot
+     *  assigned to \p cid but there are no more free slots left.
+     */
+    Ctx*
+    get(
+        const ContextMgr_CID_t cid)
+    {
+        for (std::size_t i = 0; i < used_; i++)
+        {
+            if (cid == cids_[i])
+            {
+                return &*ctxs_[i];
+            }
+        }
+
+        if (N == used_)
+        {
+            return nullptr;
+        }
+
+        cids_[used_] = cid;
+        if constexpr (std::is_constructible_v<Ctx, WithCid, ContextMgr_CID_t>)
+        {
+            ctxs_[used_].emplace(WithCid{}, cid);
+        }
+        else
+        {
+            ctxs_[used_].emplace();
+        }
+
+        return &*ctxs_[used_++];
+    }
+
+    /**
+     * @brief Get number of client contexts in use
+     */
+    std::size_t
+    size() const noexcept
+    {
+        return used_;
+    }
+
+private:
+    // Slots are handed out in order and never given back, so keep the CIDs
+    // separate from the contexts to make the search as compact as possible
+    std::array<ContextMgr_CID_t, N> cids_{};
+    std::array<std::optional<Ctx>, N> ctxs_{};
+    std::size_t used_ = 0;
+};
+
+} // namespace lib_server
@@ -22,15 +22,73 @@
 
 typedef void* HandleMgr_Handle_t;
 
+/**
+ * These functions will be called by a growable HandleMgr to alloc/free the
+ * memory which holds the handles; their signatures match malloc() and free().
+ */
+typedef struct
+{
+    void* (*alloc)(
+        size_t size);
+    void (*free)(
+        void* mem);
+} HandleMgr_MemoryFuncs_t;
+
+/**
+ * How handles are kept and looked up by the handle manager
+ */
+typedef enum
+{
+    /**
+     * Handles are kept in the order they were added and searched linearly,
+     * which is fastest for small sets and cheap to change (default)
+     */
+    HandleMgr_MODE_LINEAR = 0,
+    /**
+     * Handles are kept sorted by value and searched with a binary search;
+     * this is meant for large sets which rarely change after being set up
+     */
+    HandleMgr_MODE_SORTED,
+    /**
+     * Handles are kept in a fixed hash table of small buckets, where each
+     * handle may go into one of two buckets; every operation inspects at most
+     * two buckets, regardless of how many handles there are. This is meant
+     * for real-time servers which need a bound on the worst case
+     */
+    HandleMgr_MODE_BOUNDED,
+    /**
+     * Like HandleMgr_MODE_LINEAR, but every handle found by validate() is
+     * swapped with the one before it, so the handles used most move to the
+     * front and are found within the first few comparisons; this is meant for
+     * small sets where few handles get most of the lookups
+     */
+    HandleMgr_MODE_TRANSPOSE,
+} HandleMgr_Mode_t;
+
 typedef struct HandleMgr
 {
     PointerVector vector;
+    HandleMgr_Mode_t mode;
+    size_t capacity;
+    size_t minCapacity;
+    void* buffer;
+    HandleMgr_MemoryFuncs_t memFns;
+    uint32_t* filter;
+    size_t filterBits;
 }
 HandleMgr_t;
 
 #define HandleMgr_SIZE_OF_BUFFER(numItems)\
     PointerVector_SIZE_OF_BUFFER(numItems)
 
+// Number of handles per bucket in HandleMgr_MODE_BOUNDED
+#define HandleMgr_BUCKET_SIZE 8
+
+// With 16 bits per handle and two hash functions, the filter lets less than
+// 2% of unknown handles pass through to the full lookup
+#define HandleMgr_SIZE_OF_FILTER(numItems)\
+    (sizeof(uint32_t) * ((numItems) / 2 + 1))
+
 /**
  * @brief Initialize a handle manager instance
  *
@@ -60,6 +118,100 @@ HandleMgr_init(
     size_t bufSize,
     size_t* capacityNumHandles);
 
+/**
+ * @brief Initialize a growable handle manager instance
+ *
+ * Initialize a handle manager instance which allocates the memory for its
+ * handles via the callbacks in \p memFns. The memory starts out with
+ * \p capacityNumHandles and is doubled whenever an add() finds it full; it
+ * is halved again when less than a quarter is in use, but never shrinks below
+ * the initial capacity. This way memory use follows the actual number of
+ * handles, instead of having to be sized for the worst case.
+ *
+ * @param self (required) pointer to handle manager
+ * @param memFns (required) callbacks to alloc/free memory
+ * @param capacityNumHandles (required) initial capacity in number of elements
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the initial allocation failed
+ */
+OS_Error_t
+HandleMgr_initGrowable(
+    HandleMgr_t* self,
+    const HandleMgr_MemoryFuncs_t* memFns,
+    size_t capacityNumHandles);
+
+/**
+ * @brief Set up a filter to quickly reject unknown handles
+ *
+ * Attach a Bloom filter to the handle manager, which is consulted by
+ * validate() and add() before the list of handles is searched. This way
+ * unknown handles (e.g., passed by a misbehaving client) are rejected with a
+ * few instructions, instead of a full search. The filter is updated on add()
+ * and rebuilt on remove(); handles already added are taken over.
+ *
+ * The size of the filter memory should be obtained via
+ * HandleMgr_SIZE_OF_FILTER(), based on the expected number of handles.
+ *
+ * @param self (required) pointer to handle manager
+ * @param buffer (required) memory buffer to store the filter, aligned to 32 bit
+ * @param bufSize (required) size of memory buffer to store the filter
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_NOT_SUPPORTED if the handle manager is in
+ *  HandleMgr_MODE_BOUNDED
+ */
+OS_Error_t
+HandleMgr_initFilter(
+    HandleMgr_t* self,
+    void* buffer,
+    size_t bufSize);
+
+/**
+ * @brief Set the mode of a handle manager instance
+ *
+ * Switch how handles are stored and looked up, see HandleMgr_Mode_t. In
+ * HandleMgr_MODE_SORTED, validate() needs O(log n) steps but add() and remove()
+ * have to move O(n) handles to keep the order; no memory is needed beyond
+ * HandleMgr_SIZE_OF_BUFFER(). Large sets are best set up with addBatch(),
+ * which merges all handles in one pass.
+ *
+ * In HandleMgr_MODE_BOUNDED, add(), remove() and validate() each look at no
+ * more than 2 * HandleMgr_BUCKET_SIZE handles, so their worst case does not
+ * depend on the number of handles; the table is never resized or rehashed.
+ * As a handle can only go into one of its two buckets, add() may fail before
+ * the capacity is reached: a table filled to about 50% practically never
+ * rejects a handle, so the buffer should be sized for twice the number of
+ * handles expected. This mode can not be used with a growable handle manager
+ * or with a filter (which would not speed up a bounded lookup anyway).
+ *
+ * In HandleMgr_MODE_TRANSPOSE, validate() and add() are O(n) as in the
+ * default mode, but validate() reorders the handles; it thus changes the
+ * handle manager and must be protected from concurrent calls just like add().
+ * New handles are added at the back, remove() keeps the order of the other
+ * handles. No additional memory is needed.
+ *
+ * The mode can only be set as long as the handle manager is empty.
+ *
+ * @param self (required) pointer to handle manager
+ * @param mode (required) mode to use
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_STATE if the handle manager is not empty
+ * @retval OS_ERROR_NOT_SUPPORTED if HandleMgr_MODE_BOUNDED was requested for
+ *  a growable handle manager or one with a filter
+ */
+OS_Error_t
+HandleMgr_setMode(
+    HandleMgr_t* self,
+    HandleMgr_Mode_t mode);
+
 /**
  * @brief Free a handle manager instance
  *
@@ -83,7 +235,9 @@ HandleMgr_free(
  * @retval OS_SUCCESS if operation succeeded
  * @retval OS_ERROR_OPERATION_DENIED handle is duplicated
  * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
- * @retval OS_ERROR_INSUFFICIENT_SPACE if an allocation failed
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the handle manager is full and could
+ *  not be grown; in HandleMgr_MODE_BOUNDED, if both buckets of the handle are
+ *  full
  */
 OS_Error_t
 HandleMgr_add(
@@ -136,6 +290,34 @@ HandleMgr_addOnSuccess(
            (OS_SUCCESS == ret) ? HandleMgr_add(self, *handle) : ret;
 }
 
+/**
+ * @brief Add multiple handles to manager
+ *
+ * Either all handles are added or none. In HandleMgr_MODE_SORTED, the handles
+ * are merged with the ones already known in a single pass, instead of moving
+ * the handles for each of them separately. In HandleMgr_MODE_BOUNDED, they
+ * are added one by one and taken out again if one of them does not fit.
+ *
+ * NOTE: To find duplicates without additional memory, \p handles is sorted in
+ *       place, i.e., the order of elements in \p handles is not preserved.
+ *
+ * @param self (required) handle manager
+ * @param handles (required) array of handles, will be reordered
+ * @param numHandles (required) number of handles in array
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_OPERATION_DENIED a handle is duplicated
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the handle manager has no room for
+ *  all handles and could not be grown
+ */
+OS_Error_t
+HandleMgr_addBatch(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t* handles,
+    size_t numHandles);
+
 /**
  * @brief Remove handle from manager
  *
@@ -179,6 +361,33 @@ HandleMgr_removeOnSuccess(
     return ret != OS_SUCCESS ? ret : HandleMgr_remove(self, handle);
 }
 
+/**
+ * @brief Remove multiple handles from manager
+ *
+ * Either all handles are removed or none. Instead of moving the remaining
+ * handles for each removed one, they are compacted in a single pass; in
+ * HandleMgr_MODE_SORTED, this is a merge of both sorted lists. In
+ * HandleMgr_MODE_BOUNDED, the slots of the handles are simply freed.
+ *
+ * NOTE: To find duplicates without additional memory, \p handles is sorted in
+ *       place, i.e., the order of elements in \p handles is not preserved.
+ *
+ * @param self (required) handle manager
+ * @param handles (required) array of handles, will be reordered
+ * @param numHandles (required) number of handles in array
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_HANDLE if a handle is not known or is contained
+ *  more than once in \p handles
+ */
+OS_Error_t
+HandleMgr_removeBatch(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t* handles,
+    size_t numHandles);
+
 /**
  * @brief Validate handle
  *
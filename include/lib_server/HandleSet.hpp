@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief Header-only C++ variant of the HandleMgr with compile-time capacity
+ *
+ * The HandleSet implements the same algorithm as the HandleMgr, but as its
+ * capacity and storage are fixed at compile time and handles are typed, the
+ * compiler can specialize and inline everything; no memory is allocated.
+ */
+
+#pragma once
+
+extern "C"
+{
+#include "lib_server/HandleMgr.h"
+}
+
+#include <array>
+#include <cstddef>
+
+namespace lib_server
+{
+
+template <typename T, std::size_t N>
+class HandleSet
+{
+    static_assert(N > 0, "HandleSet needs a capacity of at least one handle");
+
+public:
+    /**
+     * Maximum number of handles which can be stored
+     */
+    static constexpr std::size_t capacity = N;
+
+    /**
+     * Amount of memory needed for the handles, e.g. to compare with a
+     * HandleMgr_t using the same capacity
+     */
+    static constexpr std::size_t sizeOfBuffer = sizeof(T*) * N;
+
+    /**
+     * @brief Add handle to set
+     *
+     * @return an error code
+     * @retval OS_SUCCESS if operation succeeded
+     * @retval OS_ERROR_OPERATION_DENIED handle is duplicated
+     * @retval OS_ERROR_INVALID_PARAMETER if handle was NULL
+     * @retval OS_ERROR_INSUFFICIENT_SPACE if the set is full
+     */
+    OS_Error_t
+    add(
+        T* handle) noexcept
+    {
+        if (nullptr == handle)
+        {
+            return OS_ERROR_INVALID_PARAMETER;
+        }
+        if (find(handle) != npos)
+        {
+            return OS_ERROR_OPERATION_DENIED;
+        }
+        if (N == size_)
+        {
+            return OS_ERROR_INSUFFICIENT_SPACE;
+        }
+
+        handles_[size_++] = handle;
+
+        return OS_SUCCESS;
+    }
+
+    /**
+     * @brief Remove handle from set
+     *
+     * @return an error code
+     * @retval OS_SUCCESS if operation succeeded
+     * @retval OS_ERROR_INVALID_PARAMETER if handle was NULL
+     * @retval OS_ERROR_INVALID_HANDLE if the handle is not known
+     */
+    OS_Error_t
+    remove(
+        T* handle) noexcept
+    {
+        std::size_t idx;
+
+        if (nullptr == handle)
+        {
+            return OS_ERROR_INVALID_PARAMETER;
+        }
+        if ((idx = find(handle)) == npos)
+        {
+            return OS_ERROR_INVALID_HANDLE;
+        }
+
+        handles_[idx] = handles_[--size_];
+
+        return OS_SUCCESS;
+    }
+
+    /**
+     * @brief Validate handle
+     *
+     * @return \p handle if handle is known, nullptr otherwise
+     */
+    T*
+    validate(
+        T* handle) const noexcept
+    {
+        return (nullptr != handle) && (find(handle) != npos) ? handle : nullptr;
+    }
+
+    /**
+     * @brief Get number of handles in set
+     */
+    std::size_t
+    size() const noexcept
+    {
+        return size_;
+    }
+
+private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::size_t
+    find(
+        const T* handle) const noexcept
+    {
+        for (std::size_t i = 0; i < size_; i++)
+        {
+            if (handle == handles_[i])
+            {
+                return i;
+            }
+        }
+
+        return npos;
+    }
+
+    std::array<T*, N> handles_{};
+    std::size_t size_ = 0;
+};
+
+} // namespace lib_server
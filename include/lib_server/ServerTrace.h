@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief Tracing of ContextMgr and HandleMgr operations
+ *
+ * Every public function of the ContextMgr and the HandleMgr records an event
+ * with its arguments, result and duration. Tracing is only compiled in if
+ * LIB_SERVER_TRACE is defined (CMake option of the same name); otherwise all
+ * macros below expand to nothing and there is no cost at all.
+ *
+ * Events are recorded into a ring buffer per thread, so recording needs no
+ * locks and threads do not contend. The ring buffers are taken from a static
+ * pool of LIB_SERVER_TRACE_THREADS buffers with LIB_SERVER_TRACE_EVENTS events
+ * each; events of threads beyond that are dropped and counted. Buffers are
+ * kept when their thread ends, so they can still be dumped; only
+ * ServerTrace_reset() gives them all back.
+ */
+
+#pragma once
+
+#include "OS_Error.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Operations which are traced
+ */
+typedef enum
+{
+    ServerTrace_CONTEXTMGR_INIT = 0,
+    ServerTrace_CONTEXTMGR_INIT_BOUNDED,
+    ServerTrace_CONTEXTMGR_FREE,
+    ServerTrace_CONTEXTMGR_GET,
+    ServerTrace_CONTEXTMGR_ALLOC,   /**< init() callback during a get() */
+    ServerTrace_HANDLEMGR_INIT,
+    ServerTrace_HANDLEMGR_INIT_GROWABLE,
+    ServerTrace_HANDLEMGR_INIT_FILTER,
+    ServerTrace_HANDLEMGR_SET_MODE,
+    ServerTrace_HANDLEMGR_FREE,
+    ServerTrace_HANDLEMGR_ADD,
+    ServerTrace_HANDLEMGR_ADD_BATCH,
+    ServerTrace_HANDLEMGR_REMOVE,
+    ServerTrace_HANDLEMGR_REMOVE_BATCH,
+    ServerTrace_HANDLEMGR_VALIDATE, /**< result is OS_SUCCESS if valid */
+    ServerTrace_NUM_OPS
+} ServerTrace_Op_t;
+
+/**
+ * A single recorded event
+ */
+typedef struct
+{
+    uint64_t start;     /**< timestamp when operation was entered */
+    uint64_t duration;  /**< time spent in operation */
+    const void* self;   /**< instance the operation was called on */
+    uintptr_t arg;      /**< CID, handle or other main argument */
+    int32_t result;     /**< OS_Error_t returned by operation */
+    uint16_t op;        /**< ServerTrace_Op_t */
+} ServerTrace_Event_t;
+
+/**
+ * Returns the current time in arbitrary but monotonic units, e.g., ns or
+ * cycles; used to timestamp events.
+ */
+typedef uint64_t (*ServerTrace_ClockFunc_t)(void);
+
+/**
+ * Called by ServerTrace_dump() for every recorded event, oldest first per
+ * thread; \p thread is the index of the ring buffer of the thread.
+ */
+typedef void (*ServerTrace_DumpFunc_t)(
+    size_t                     thread,
+    const ServerTrace_Event_t* event,
+    void*                      ctx);
+
+#if defined(LIB_SERVER_TRACE)
+
+// These can be overridden at compile time
+#if !defined(LIB_SERVER_TRACE_THREADS)
+#   define LIB_SERVER_TRACE_THREADS 16
+#endif
+#if !defined(LIB_SERVER_TRACE_EVENTS)
+#   define LIB_SERVER_TRACE_EVENTS  256
+#endif
+
+/**
+ * @brief Set the clock used for timestamps
+ *
+ * On Linux, CLOCK_MONOTONIC is used by default (in ns); on other platforms
+ * all timestamps are zero until a clock is set.
+ */
+void
+ServerTrace_setClock(
+    ServerTrace_ClockFunc_t clock);
+
+/**
+ * @brief Get a timestamp from the current clock
+ */
+uint64_t
+ServerTrace_now(void);
+
+/**
+ * @brief Record an event into the ring buffer of the calling thread
+ */
+void
+ServerTrace_record(
+    ServerTrace_Op_t op,
+    const void*      self,
+    uintptr_t        arg,
+    OS_Error_t       result,
+    uint64_t         start);
+
+/**
+ * @brief Pass all recorded events to a callback
+ *
+ * This is meant to be called when the traced threads are idle; events which
+ * are overwritten while the dump is running may be reported inconsistently.
+ *
+ * @param fn (required) callback to call for each event
+ * @param ctx (optional) context passed to callback
+ */
+void
+ServerTrace_dump(
+    ServerTrace_DumpFunc_t fn,
+    void*                  ctx);
+
+/**
+ * @brief Discard all recorded events; only call when traced threads are idle
+ *
+ * All ring buffers are given back to the pool, threads claim a new one when
+ * they record their next event.
+ */
+void
+ServerTrace_reset(void);
+
+/**
+ * @brief Get the number of events which were dropped because all ring buffers
+ *  were taken by other threads
+ */
+size_t
+ServerTrace_getDropped(void);
+
+/**
+ * @brief Get a printable name of an operation
+ */
+const char*
+ServerTrace_getOpName(
+    ServerTrace_Op_t op);
+
+/**
+ * Take a timestamp into the local variable \p t when entering an operation
+ */
+#define ServerTrace_BEGIN(t) \
+    const uint64_t t = ServerTrace_now()
+
+/**
+ * Record operation \p op on \p self with \p arg and \p result, which started
+ * at the timestamp \p t
+ */
+#define ServerTrace_END(t, op, self, arg, result) \
+    ServerTrace_record((op), (self), (uintptr_t) (arg), (result), (t))
+
+#else
+
+#define ServerTrace_BEGIN(t)
+#define ServerTrace_END(t, op, self, arg, result) do {} while (0)
+
+#endif
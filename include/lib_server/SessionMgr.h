@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief The SessionMgr manages client contexts along with their handles
+ *
+ * Object-level RPCs typically look up the client context with the
+ * ContextMgr and then validate a handle with a HandleMgr stored inside that
+ * context, which means chasing pointers through unrelated memory twice. The
+ * SessionMgr combines both: every client slot embeds the handle manager of
+ * that client and the memory for its handles, so resolve() finds the context
+ * and validates the handle in one go. CIDs are kept in a separate, compact
+ * array, so looking them up touches as little memory as possible.
+ *
+ * As every client has its own handles, a client with many handles does not
+ * slow down validation for the others. Additionally, each client has a quota
+ * which limits how many handles it may hold; by default it is the maximum
+ * amount of handles per client given to init().
+ */
+
+#pragma once
+
+#include "OS_Error.h"
+#include "lib_server/ContextMgr.h"
+#include "lib_server/HandleMgr.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Forward declaration
+typedef struct SessionMgr_ClientSlot SessionMgr_ClientSlot_t;
+
+/**
+ * Context of session manager, needs to be allocated by user of SessionMgr.
+ */
+typedef struct
+{
+    size_t max;
+    size_t used;
+    size_t maxHandles;
+    size_t slotSize;
+    ContextMgr_CID_t* cids;
+    SessionMgr_ClientSlot_t* slots;
+    ContextMgr_MemoryFuncs_t memFns;
+} SessionMgr_t;
+
+/**
+ * @brief Initialize a session manager instance
+ *
+ * Initialize a session manager instance with memory alloc/free callbacks for
+ * client contexts, the max number of expected clients and the max number of
+ * handles per client. Will internally alloc as many slots as indicated by
+ * \p max, each with room for \p maxHandles handles.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the slots could not be allocated
+ */
+OS_Error_t
+SessionMgr_init(
+    SessionMgr_t*                   self,       /**< [in]   pointer to session
+                                                            manager */
+    const ContextMgr_MemoryFuncs_t* memFns,     /**< [in]   client context
+                                                            alloc/free
+                                                            callbacks */
+    const size_t                    max,        /**< [in]   maximum amount of
+                                                            clients expected */
+    const size_t                    maxHandles  /**< [in]   maximum amount of
+                                                            handles per client */
+);
+
+/**
+ * @brief Free a session manager instance
+ *
+ * Free session manager memory; will call the free() callback on all already
+ * allocated client contexts.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ */
+OS_Error_t
+SessionMgr_free(
+    SessionMgr_t* self  /**< [in] pointer to session manager */
+);
+
+/**
+ * @brief Get a client context based on its ID
+ *
+ * Works like ContextMgr_get(): if there is no context for that CID yet, the
+ * init() callback is used to allocate one.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if there is no slot assigned to the
+ *  \p CID but there are no more free slots left.
+ */
+OS_Error_t
+SessionMgr_get(
+    SessionMgr_t*          self,    /**< [in]   pointer to session manager */
+    const ContextMgr_CID_t cid,     /**< [in]   unique client ID to use for
+                                                lookup */
+    void**                 ctx      /**< [out]  pointer which will be set to
+                                                client context mem */
+);
+
+/**
+ * @brief Add handle to a client
+ *
+ * If the client has no context yet, it is allocated first (see get()).
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_OPERATION_DENIED handle is duplicated
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if there is no slot for the client or
+ *  the client has reached its quota
+ */
+OS_Error_t
+SessionMgr_addHandle(
+    SessionMgr_t*            self,      /**< [in]   pointer to session
+                                                    manager */
+    const ContextMgr_CID_t   cid,       /**< [in]   unique client ID */
+    const HandleMgr_Handle_t handle     /**< [in]   handle to add */
+);
+
+/**
+ * @brief Remove handle from a client
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_HANDLE if the client does not have the handle
+ */
+OS_Error_t
+SessionMgr_removeHandle(
+    SessionMgr_t*            self,      /**< [in]   pointer to session
+                                                    manager */
+    const ContextMgr_CID_t   cid,       /**< [in]   unique client ID */
+    const HandleMgr_Handle_t handle     /**< [in]   handle to remove */
+);
+
+/**
+ * @brief Resolve client context and handle of a request
+ *
+ * Look up the context of a client and validate that the client has the
+ * handle, in a single call. This never allocates a client context: a client
+ * without context has no handles either.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_HANDLE if the client does not have the handle
+ */
+OS_Error_t
+SessionMgr_resolve(
+    SessionMgr_t*            self,      /**< [in]   pointer to session
+                                                    manager */
+    const ContextMgr_CID_t   cid,       /**< [in]   unique client ID */
+    const HandleMgr_Handle_t handle,    /**< [in]   handle to validate */
+    void**                   ctx        /**< [out]  pointer which will be set
+                                                    to client context mem */
+);
+
+/**
+ * @brief Set handle quota of a client
+ *
+ * Limit the amount of handles a client may hold at the same time. If the
+ * client has no context yet, it is allocated first (see get()). If the client
+ * already holds more handles than \p quota, it keeps them but cannot add any
+ * until it dropped below the quota.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid,
+ *  e.g., if \p quota is larger than the max number of handles per client
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if there is no slot for the client
+ */
+OS_Error_t
+SessionMgr_setQuota(
+    SessionMgr_t*          self,    /**< [in]   pointer to session manager */
+    const ContextMgr_CID_t cid,     /**< [in]   unique client ID */
+    const size_t           quota    /**< [in]   max amount of handles of
+                                                client */
+);
+
+/**
+ * @brief Get number of handles a client currently holds
+ *
+ * This never allocates a client context; for a client without context the
+ * count is zero.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ */
+OS_Error_t
+SessionMgr_getCount(
+    SessionMgr_t*          self,    /**< [in]   pointer to session manager */
+    const ContextMgr_CID_t cid,     /**< [in]   unique client ID */
+    size_t*                count    /**< [out]  number of handles of client */
+);
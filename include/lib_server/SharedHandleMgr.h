@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief The SharedHandleMgr manages a list of handles in shared memory
+ *
+ * This is a variant of the HandleMgr whose handles live in a memory region
+ * shared between components, e.g., a CAmkES dataport. The component owning
+ * the objects is the single writer: it initializes the region and adds or
+ * removes handles. Sibling components attach to the same region as readers
+ * and can validate handles directly, instead of asking the owner via RPC.
+ *
+ * The region contains no pointers, only offsets relative to its start, so it
+ * may be mapped at a different address in every component. Handles are kept
+ * sorted, so validate() is a binary search. Readers never write to the
+ * region: updates are published with a sequence counter (seqlock), which a
+ * reader checks before and after its lookup and retries if the writer was
+ * active in between.
+ */
+
+#pragma once
+
+#include "OS_Error.h"
+#include "lib_server/HandleMgr.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Header at the start of the shared region; needs to be public so users can
+ * size the region. All fields have fixed sizes, so components built for
+ * different word sizes agree on the layout.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t handlesOffset;
+} SharedHandleMgr_Region_t;
+
+/**
+ * This function will be called by a reader which waits for the writer to
+ * finish an update, to give the CPU to other threads, e.g., sched_yield() or
+ * seL4_Yield().
+ */
+typedef void (*SharedHandleMgr_YieldFunc_t)(void);
+
+typedef struct SharedHandleMgr
+{
+    SharedHandleMgr_Region_t* region;
+    uint64_t* handles;
+    size_t capacity;
+    bool isWriter;
+    SharedHandleMgr_YieldFunc_t yieldFn;
+    uint32_t stuckSeq;
+}
+SharedHandleMgr_t;
+
+#define SharedHandleMgr_SIZE_OF_REGION(numItems)\
+    (sizeof(SharedHandleMgr_Region_t) + sizeof(uint64_t) * (numItems))
+
+/**
+ * @brief Initialize a shared handle manager instance as writer
+ *
+ * Format a shared memory region so it can hold handles, and use it as its
+ * (single) writer. The region should be sized via
+ * SharedHandleMgr_SIZE_OF_REGION(). Readers can only attach once this has
+ * completed.
+ *
+ * @param self (required) pointer to handle manager
+ * @param region (required) shared memory region, aligned to 64 bit
+ * @param regionSize (required) size of shared memory region
+ * @param capacityNumHandles capacity in number of elements. This is an
+ * input/output parameter. If NULL then it is simply ignored, otherwise the
+ * init will check the required number of elements against the size of the
+ * region. If the memory is not sufficient then OS_ERROR_INSUFFICIENT_SPACE
+ * will be returned otherwise the maximum capacity will be returned.
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the required amount of handles results
+ *  in a greater need of memory (than the one passed).
+ */
+OS_Error_t
+SharedHandleMgr_init(
+    SharedHandleMgr_t* self,
+    void* region,
+    size_t regionSize,
+    size_t* capacityNumHandles);
+
+/**
+ * @brief Attach to a shared handle manager instance as reader
+ *
+ * Attach to a shared memory region which was initialized by the writer. The
+ * layout is checked against \p regionSize once; a reader never accesses
+ * memory outside of the region, regardless of what the writer puts into it.
+ *
+ * @param self (required) pointer to handle manager
+ * @param region (required) shared memory region, aligned to 64 bit
+ * @param regionSize (required) size of shared memory region
+ * @param yieldFn (optional) callback to give up the CPU while waiting for the
+ * writer; if NULL the reader only spins
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_STATE if the region was not initialized or does
+ *  not fit into \p regionSize
+ */
+OS_Error_t
+SharedHandleMgr_attach(
+    SharedHandleMgr_t* self,
+    const void* region,
+    size_t regionSize,
+    SharedHandleMgr_YieldFunc_t yieldFn);
+
+/**
+ * @brief Free a shared handle manager instance
+ *
+ * The region itself is left untouched, so readers can stay attached.
+ *
+ * @param self (required) handle manager
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ */
+OS_Error_t
+SharedHandleMgr_free(
+    SharedHandleMgr_t* self);
+
+/**
+ * @brief Add handle to manager
+ *
+ * @param self (required) handle manager, must be the writer
+ * @param handle (required) handle
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_OPERATION_DENIED handle is duplicated
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_STATE if called by a reader
+ * @retval OS_ERROR_INSUFFICIENT_SPACE if the handle manager is full
+ */
+OS_Error_t
+SharedHandleMgr_add(
+    SharedHandleMgr_t* self,
+    HandleMgr_Handle_t handle);
+
+/**
+ * @brief Remove handle from manager
+ *
+ * @param self (required) handle manager, must be the writer
+ * @param handle (required) handle
+ *
+ * @return an error code
+ * @retval OS_SUCCESS if operation succeeded
+ * @retval OS_ERROR_INVALID_PARAMETER if a parameter was missing or invalid
+ * @retval OS_ERROR_INVALID_STATE if called by a reader
+ * @retval OS_ERROR_INVALID_HANDLE if the handle is not known
+ */
+OS_Error_t
+SharedHandleMgr_remove(
+    SharedHandleMgr_t* self,
+    HandleMgr_Handle_t handle);
+
+/**
+ * @brief Validate handle
+ *
+ * Can be called by the writer and by readers. While the writer is in the
+ * middle of an update, a reader waits a short, bounded time for it to finish
+ * (first spinning, then yielding the CPU if a yield function was given). A
+ * reader gives up, and treats the handle as unknown, if the data changed
+ * during a bounded number of consecutive lookups, or if the writer does not
+ * finish an update in time (e.g., because it was preempted or died). Once it
+ * gave up on an update, later lookups fail right away until the writer is
+ * done with it.
+ *
+ * @param self (required) handle manager
+ * @param handle (required) handle
+ *
+ * @return return \p handle if handle is known, NULL otherwise
+ */
+HandleMgr_Handle_t
+SharedHandleMgr_validate(
+    SharedHandleMgr_t* self,
+    HandleMgr_Handle_t handle);
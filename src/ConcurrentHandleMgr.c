@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "lib_server/ConcurrentHandleMgr.h"
+#include <string.h>
+
+#define HANDLE_NOT_FOUND ((size_t) -1)
+
+// The reference counter of a slot includes one reference held by the manager
+// itself as long as the handle was not removed; once it is removed, the flag
+// is set and the slot is released as soon as the counter drops to zero.
+#define REFS_REMOVED    ((uint32_t) 1 << 31)
+#define REFS_COUNT(r)   ((r) & ~REFS_REMOVED)
+#define REFS_MAX        (REFS_REMOVED - 1)
+
+// Private functions -----------------------------------------------------------
+
+static void
+lockWriters(
+    ConcurrentHandleMgr_t* self)
+{
+    if (NULL != self->lockFns.lock)
+    {
+        self->lockFns.lock();
+        return;
+    }
+
+    while (__atomic_test_and_set(&self->spinlock, __ATOMIC_ACQUIRE))
+    {
+        // Spin
+    }
+}
+
+static void
+unlockWriters(
+    ConcurrentHandleMgr_t* self)
+{
+    if (NULL != self->lockFns.unlock)
+    {
+        self->lockFns.unlock();
+        return;
+    }
+
+    __atomic_clear(&self->spinlock, __ATOMIC_RELEASE);
+}
+
+static size_t
+find(
+    ConcurrentHandleMgr_t* self,
+    const uintptr_t        h)
+{
+    // The high-water mark is raised before a new slot gets its handle, so a
+    // handle seen in a slot is always within what has been published; slots
+    // which are not filled yet just look empty
+    size_t used = __atomic_load_n(&self->used, __ATOMIC_ACQUIRE);
+
+    for (size_t i = 0; i < used; i++)
+    {
+        if (h == __atomic_load_n(&self->slots[i].handle, __ATOMIC_ACQUIRE))
+        {
+            return i;
+        }
+    }
+
+    return HANDLE_NOT_FOUND;
+}
+
+static bool
+isLive(
+    ConcurrentHandleMgr_Slot_t* slot)
+{
+    uint32_t refs = __atomic_load_n(&slot->refs, __ATOMIC_ACQUIRE);
+
+    return !(refs & REFS_REMOVED) && REFS_COUNT(refs) > 0;
+}
+
+// Needs to be called with the writers lock held
+static void
+releaseSlot(
+    ConcurrentHandleMgr_t* self,
+    size_t                 idx)
+{
+    ConcurrentHandleMgr_Slot_t* slot = &self->slots[idx];
+    uintptr_t h = slot->handle;
+    size_t used;
+
+    __atomic_store_n(&slot->refs, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->handle, 0, __ATOMIC_RELEASE);
+
+    // Drop free slots at the end, so readers don't have to scan them; a reader
+    // which has seen the old high-water mark will simply find them empty
+    for (used = self->used; used > 0 && 0 == self->slots[used - 1].handle;)
+    {
+        used--;
+    }
+    __atomic_store_n(&self->used, used, __ATOMIC_RELEASE);
+
+    if (NULL != self->releaseFn)
+    {
+        self->releaseFn((HandleMgr_Handle_t) h);
+    }
+}
+
+// Returns true if the caller has dropped the last reference and thus needs
+// to release the slot
+static bool
+putSlot(
+    ConcurrentHandleMgr_Slot_t* slot)
+{
+    return __atomic_sub_fetch(&slot->refs, 1, __ATOMIC_ACQ_REL) == REFS_REMOVED;
+}
+
+// Public functions ------------------------------------------------------------
+
+OS_Error_t
+ConcurrentHandleMgr_init(
+    ConcurrentHandleMgr_t*                 self,
+    void*                                  buffer,
+    size_t                                 bufSize,
+    size_t*                                capacityNumHandles,
+    const ConcurrentHandleMgr_LockFuncs_t* lockFns,
+    ConcurrentHandleMgr_ReleaseFunc_t      releaseFn)
+{
+    if (NULL == self || NULL == buffer || 0 == bufSize)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+    if (NULL != lockFns && (NULL == lockFns->lock || NULL == lockFns->unlock))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    size_t myCapacityNumHandles = bufSize / sizeof(ConcurrentHandleMgr_Slot_t);
+    if (0 == myCapacityNumHandles)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+    if (capacityNumHandles != NULL &&
+        *capacityNumHandles > myCapacityNumHandles)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    memset(buffer, 0, myCapacityNumHandles * sizeof(ConcurrentHandleMgr_Slot_t));
+
+    self->slots     = buffer;
+    self->capacity  = myCapacityNumHandles;
+    self->used      = 0;
+    self->spinlock  = false;
+    self->releaseFn = releaseFn;
+    if (NULL != lockFns)
+    {
+        self->lockFns = *lockFns;
+    }
+    else
+    {
+        memset(&self->lockFns, 0, sizeof(self->lockFns));
+    }
+
+    if (capacityNumHandles != NULL)
+    {
+        *capacityNumHandles = myCapacityNumHandles;
+    }
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+ConcurrentHandleMgr_free(
+    ConcurrentHandleMgr_t* self)
+{
+    if (NULL == self)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    self->used = 0;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+ConcurrentHandleMgr_add(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle)
+{
+    OS_Error_t err;
+    size_t idx;
+
+    if (NULL == self || NULL == handle)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    lockWriters(self);
+
+    // A handle which was removed but is still referenced also counts as a
+    // duplicate, as the object behind it still exists
+    if (find(self, (uintptr_t) handle) != HANDLE_NOT_FOUND)
+    {
+        err = OS_ERROR_OPERATION_DENIED;
+        goto out;
+    }
+
+    // Re-use a slot which has become free, only append if there is none; this
+    // keeps the range readers have to scan as short as possible
+    if ((idx = find(self, 0)) == HANDLE_NOT_FOUND)
+    {
+        if (self->used >= self->capacity)
+        {
+            err = OS_ERROR_INSUFFICIENT_SPACE;
+            goto out;
+        }
+        idx = self->used;
+    }
+
+    // The reference counter and the high-water mark need to be visible before
+    // the handle is, so acquire() can never see the handle without the
+    // manager's reference, and release() will always find what acquire() got.
+    // The counter is stored with release semantics, as a reader may still be
+    // looking at a re-used slot for the handle it held before: if it sees the
+    // new count, it must also see that releaseSlot() cleared the old handle,
+    // otherwise its check of the handle could still match the released one
+    __atomic_store_n(&self->slots[idx].refs, 1, __ATOMIC_RELEASE);
+    if (idx == self->used)
+    {
+        __atomic_store_n(&self->used, self->used + 1, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&self->slots[idx].handle, (uintptr_t) handle,
+                     __ATOMIC_RELEASE);
+
+    err = OS_SUCCESS;
+
+out:
+    unlockWriters(self);
+    return err;
+}
+
+OS_Error_t
+ConcurrentHandleMgr_remove(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle)
+{
+    size_t idx;
+
+    if (NULL == self || NULL == handle)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    lockWriters(self);
+
+    if ((idx = find(self, (uintptr_t) handle)) == HANDLE_NOT_FOUND ||
+        !isLive(&self->slots[idx]))
+    {
+        unlockWriters(self);
+        return OS_ERROR_INVALID_HANDLE;
+    }
+
+    // Hide the handle from validate()/acquire(), then drop the reference of
+    // the manager; whoever drops the last reference releases the slot
+    __atomic_fetch_or(&self->slots[idx].refs, REFS_REMOVED, __ATOMIC_ACQ_REL);
+    if (putSlot(&self->slots[idx]))
+    {
+        releaseSlot(self, idx);
+    }
+
+    unlockWriters(self);
+
+    return OS_SUCCESS;
+}
+
+HandleMgr_Handle_t
+ConcurrentHandleMgr_validate(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle)
+{
+    ConcurrentHandleMgr_Slot_t* slot;
+    size_t idx;
+
+    // Let NULL pointers simply pass through
+    if (NULL == self || NULL == handle)
+    {
+        return NULL;
+    }
+
+    if ((idx = find(self, (uintptr_t) handle)) == HANDLE_NOT_FOUND)
+    {
+        return NULL;
+    }
+
+    // The slot may have been released and re-used for another handle between
+    // find() and isLive(), then the state we saw is not the one of our handle
+    slot = &self->slots[idx];
+    return isLive(slot) &&
+           (uintptr_t) handle == __atomic_load_n(&slot->handle,
+                                                 __ATOMIC_ACQUIRE) ?
+           handle : NULL;
+}
+
+HandleMgr_Handle_t
+ConcurrentHandleMgr_acquire(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle)
+{
+    ConcurrentHandleMgr_Slot_t* slot;
+    size_t idx;
+    uint32_t refs;
+
+    // Let NULL pointers simply pass through
+    if (NULL == self || NULL == handle)
+    {
+        return NULL;
+    }
+
+    if ((idx = find(self, (uintptr_t) handle)) == HANDLE_NOT_FOUND)
+    {
+        return NULL;
+    }
+
+    slot = &self->slots[idx];
+    refs = __atomic_load_n(&slot->refs, __ATOMIC_ACQUIRE);
+    do
+    {
+        if ((refs & REFS_REMOVED) || 0 == refs || REFS_MAX == refs)
+        {
+            return NULL;
+        }
+    }
+    while (!__atomic_compare_exchange_n(&slot->refs, &refs, refs + 1, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    // The slot may have been released and re-used for another handle between
+    // find() and taking the reference, in that case give it back
+    if ((uintptr_t) handle != __atomic_load_n(&slot->handle, __ATOMIC_ACQUIRE))
+    {
+        if (putSlot(slot))
+        {
+            lockWriters(self);
+            releaseSlot(self, idx);
+            unlockWriters(self);
+        }
+        return NULL;
+    }
+
+    return handle;
+}
+
+OS_Error_t
+ConcurrentHandleMgr_release(
+    ConcurrentHandleMgr_t* self,
+    HandleMgr_Handle_t     handle)
+{
+    ConcurrentHandleMgr_Slot_t* slot;
+    size_t idx;
+    uint32_t refs;
+
+    if (NULL == self || NULL == handle)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if ((idx = find(self, (uintptr_t) handle)) == HANDLE_NOT_FOUND)
+    {
+        return OS_ERROR_INVALID_HANDLE;
+    }
+
+    // Make sure we never drop the reference held by the manager itself, the
+    // caller must have acquired the handle before
+    slot = &self->slots[idx];
+    refs = __atomic_load_n(&slot->refs, __ATOMIC_ACQUIRE);
+    do
+    {
+        if (REFS_COUNT(refs) <= ((refs & REFS_REMOVED) ? 0 : 1))
+        {
+            return OS_ERROR_INVALID_STATE;
+        }
+    }
+    while (!__atomic_compare_exchange_n(&slot->refs, &refs, refs - 1, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    if (REFS_REMOVED == refs - 1)
+    {
+        lockWriters(self);
+        releaseSlot(self, idx);
+        unlockWriters(self);
+    }
+
+    return OS_SUCCESS;
+}
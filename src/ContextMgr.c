@@ -8,6 +8,7 @@
 
 #include "lib_debug/Debug.h"
 #include "lib_server/ContextMgr.h"
+#include "lib_server/ServerTrace.h"
 #include "lib_macros/Check.h"
 #include "lib_utils/PointerVector.h"
 
@@ -26,13 +27,14 @@ struct ContextMgr_ClientSlot
     void* mem;
 };
 
-// Public functions ------------------------------------------------------------
+// Private functions -----------------------------------------------------------
 
-OS_Error_t
-ContextMgr_init(
+static OS_Error_t
+setup(
     ContextMgr_t*                   self,
     const ContextMgr_MemoryFuncs_t* memFns,
-    const size_t                    max)
+    const size_t                    max,
+    const size_t                    numSlots)
 {
     CHECK_PTR_NOT_NULL(self);
     CHECK_PTR_NOT_NULL(memFns);
@@ -42,11 +44,14 @@ ContextMgr_init(
                                    CONTEXTMGR_CONTEXTS_MIN,
                                    CONTEXTMGR_CONTEXTS_MAX);
 
-    self->memFns = *memFns;
-    self->max    = max;
+    self->memFns     = *memFns;
+    self->max        = max;
+    self->numSlots   = numSlots;
+    self->numBuckets = 0;
+    self->used       = 0;
 
-    // Allocate as many client slots as user requested
-    if ((self->slots = calloc(max, sizeof(ContextMgr_ClientSlot_t))) == NULL)
+    if ((self->slots = calloc(numSlots,
+                              sizeof(ContextMgr_ClientSlot_t))) == NULL)
     {
         Debug_LOG_ERROR("calloc() failed");
         return OS_ERROR_INSUFFICIENT_SPACE;
@@ -55,8 +60,152 @@ ContextMgr_init(
     return OS_SUCCESS;
 }
 
-OS_Error_t
-ContextMgr_free(
+static OS_Error_t
+doInit(
+    ContextMgr_t*                   self,
+    const ContextMgr_MemoryFuncs_t* memFns,
+    const size_t                    max)
+{
+    // Allocate as many client slots as user requested
+    return setup(self, memFns, max, max);
+}
+
+static OS_Error_t
+doInitBounded(
+    ContextMgr_t*                   self,
+    const ContextMgr_MemoryFuncs_t* memFns,
+    const size_t                    max)
+{
+    OS_Error_t err;
+    size_t numBuckets;
+
+    CHECK_VALUE_IN_CLOSED_INTERVAL(max,
+                                   CONTEXTMGR_CONTEXTS_MIN,
+                                   CONTEXTMGR_CONTEXTS_MAX);
+
+    // With twice as many slots as clients, buckets are at most half full on
+    // average; with two buckets to choose from, a full one is very unlikely
+    numBuckets = (2 * max + ContextMgr_BUCKET_SIZE - 1) /
+                 ContextMgr_BUCKET_SIZE;
+    if ((err = setup(self, memFns, max,
+                     numBuckets * ContextMgr_BUCKET_SIZE)) != OS_SUCCESS)
+    {
+        return err;
+    }
+    self->numBuckets = numBuckets;
+
+    return OS_SUCCESS;
+}
+
+// Get the index of the first slot of both buckets a CID may be stored in
+static void
+getBuckets(
+    const ContextMgr_t*    self,
+    const ContextMgr_CID_t cid,
+    size_t*                b1,
+    size_t*                b2)
+{
+    uint64_t x = (uint64_t) cid * 0x9e3779b97f4a7c15ULL;
+
+    // Mix all bits and map each half onto the buckets without a modulo
+    x ^= x >> 29;
+    *b1 = (size_t) ((((uint64_t) (uint32_t) x) * self->numBuckets) >> 32) *
+          ContextMgr_BUCKET_SIZE;
+    *b2 = (size_t) (((x >> 32) * self->numBuckets) >> 32) *
+          ContextMgr_BUCKET_SIZE;
+}
+
+static ContextMgr_ClientSlot_t*
+findInBucket(
+    ContextMgr_t*          self,
+    const size_t           b,
+    const ContextMgr_CID_t cid)
+{
+    ContextMgr_ClientSlot_t* slot;
+
+    for (size_t i = b; i < b + ContextMgr_BUCKET_SIZE; i++)
+    {
+        slot = &self->slots[i];
+        if (slot->inUse && slot->cid == cid)
+        {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+// Count the free slots of a bucket and get the first one
+static size_t
+countFree(
+    ContextMgr_t*             self,
+    const size_t              b,
+    ContextMgr_ClientSlot_t** slot)
+{
+    size_t n = 0;
+
+    for (size_t i = b + ContextMgr_BUCKET_SIZE; i > b; i--)
+    {
+        if (!self->slots[i - 1].inUse)
+        {
+            *slot = &self->slots[i - 1];
+            n++;
+        }
+    }
+
+    return n;
+}
+
+static OS_Error_t
+getBounded(
+    ContextMgr_t*          self,
+    const ContextMgr_CID_t cid,
+    void**                 ctx)
+{
+    OS_Error_t err;
+    ContextMgr_ClientSlot_t* slot, *s1 = NULL, *s2 = NULL;
+    size_t b1, b2, n1, n2;
+
+    getBuckets(self, cid, &b1, &b2);
+    if ((slot = findInBucket(self, b1, cid)) != NULL ||
+        (slot = findInBucket(self, b2, cid)) != NULL)
+    {
+        *ctx = slot->mem;
+        return OS_SUCCESS;
+    }
+
+    // Use the emptier bucket, this keeps the buckets balanced
+    n1 = countFree(self, b1, &s1);
+    n2 = countFree(self, b2, &s2);
+    if (self->used == self->max || (0 == n1 && 0 == n2))
+    {
+        Debug_LOG_ERROR("Could not find free context slot for client " \
+                        "(CID=%i)", cid);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    slot = (n1 >= n2) ? s1 : s2;
+    ServerTrace_BEGIN(tAlloc);
+    err = self->memFns.init(cid, &slot->mem);
+    ServerTrace_END(tAlloc, ServerTrace_CONTEXTMGR_ALLOC, self, cid, err);
+    if (err != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("init() callback failed on client (CID=%i) " \
+                        "with %d", cid, err);
+        slot->mem = NULL;
+        return err;
+    }
+    slot->cid   = cid;
+    slot->inUse = true;
+    self->used++;
+
+    *ctx = slot->mem;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+doFree(
     ContextMgr_t* self)
 {
     OS_Error_t err;
@@ -66,7 +215,7 @@ ContextMgr_free(
 
     // Go through client array and call respective free on those which were
     // allocated
-    for (size_t i = 0; i < self->max; i++)
+    for (size_t i = 0; i < self->numSlots; i++)
     {
         slot = &self->slots[i];
         if (slot->mem != NULL)
@@ -83,12 +232,13 @@ ContextMgr_free(
     }
 
     free(self->slots);
+    self->used = 0;
 
     return OS_SUCCESS;
 }
 
-OS_Error_t
-ContextMgr_get(
+static OS_Error_t
+doGet(
     ContextMgr_t*          self,
     const ContextMgr_CID_t cid,
     void**                 ctx)
@@ -101,6 +251,11 @@ ContextMgr_get(
     CHECK_PTR_NOT_NULL(self);
     CHECK_PTR_NOT_NULL(ctx);
 
+    if (self->numBuckets > 0)
+    {
+        return getBounded(self, cid, ctx);
+    }
+
     // Check if we already have a slot for this CID
     freeSlot = INVALID_SLOT;
     for (size_t i = 0; i < self->max; i++)
@@ -131,10 +286,18 @@ ContextMgr_get(
                               "NULL", freeSlot);
         slot->cid = cid;
         slot->inUse = true;
-        if ((err = self->memFns.init(cid, &slot->mem)) != OS_SUCCESS)
+        ServerTrace_BEGIN(tAlloc);
+        err = self->memFns.init(cid, &slot->mem);
+        ServerTrace_END(tAlloc, ServerTrace_CONTEXTMGR_ALLOC, self, cid, err);
+        if (err != OS_SUCCESS)
         {
             Debug_LOG_ERROR("init() callback failed on client (CID=%i) " \
                             "with %d", cid, err);
+            // Give the slot back, otherwise it would be lost and a retry of
+            // the client would get a NULL context
+            slot->mem   = NULL;
+            slot->cid   = 0;
+            slot->inUse = false;
             return err;
         }
         *ctx = slot->mem;
@@ -145,3 +308,63 @@ ContextMgr_get(
 
     return OS_ERROR_INSUFFICIENT_SPACE;
 }
+
+// Public functions ------------------------------------------------------------
+
+OS_Error_t
+ContextMgr_init(
+    ContextMgr_t*                   self,
+    const ContextMgr_MemoryFuncs_t* memFns,
+    const size_t                    max)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doInit(self, memFns, max);
+    ServerTrace_END(t, ServerTrace_CONTEXTMGR_INIT, self, max, err);
+
+    return err;
+}
+
+OS_Error_t
+ContextMgr_initBounded(
+    ContextMgr_t*                   self,
+    const ContextMgr_MemoryFuncs_t* memFns,
+    const size_t                    max)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doInitBounded(self, memFns, max);
+    ServerTrace_END(t, ServerTrace_CONTEXTMGR_INIT_BOUNDED, self, max, err);
+
+    return err;
+}
+
+OS_Error_t
+ContextMgr_free(
+    ContextMgr_t* self)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doFree(self);
+    ServerTrace_END(t, ServerTrace_CONTEXTMGR_FREE, self, 0, err);
+
+    return err;
+}
+
+OS_Error_t
+ContextMgr_get(
+    ContextMgr_t*          self,
+    const ContextMgr_CID_t cid,
+    void**                 ctx)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doGet(self, cid, ctx);
+    ServerTrace_END(t, ServerTrace_CONTEXTMGR_GET, self, cid, err);
+
+    return err;
+}
@@ -6,23 +6,266 @@
  * For commercial licensing, contact: info.cyber@hensoldt.net
  */
 
+#include "lib_debug/Debug.h"
 #include "lib_server/HandleMgr.h"
+#include "lib_server/ServerTrace.h"
+#include <stdlib.h>
 #include <string.h>
 
 #define HANDLE_NOT_FOUND ((size_t) -1)
 
+// Largest capacity whose buffer size can still be expressed in a size_t
+#define MAX_CAPACITY (SIZE_MAX / sizeof(Pointer))
+
 // As we cast HandleMgr_Handle_t to Pointer in order to store it in a Vector
 // container then we should at the least grant size compatibility
 Debug_STATIC_ASSERT(sizeof(HandleMgr_Handle_t) == sizeof(Pointer));
 
 // Private functions -----------------------------------------------------------
 
+static uint64_t
+hash(
+    const HandleMgr_Handle_t h)
+{
+    // Handles are pointers and thus aligned, so mix all bits before use
+    uint64_t x = (uint64_t) (uintptr_t) h;
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+
+    return x;
+}
+
 static size_t
-find(
+filterBit(
+    const HandleMgr_t* self,
+    const uint32_t     x)
+{
+    // Map the hash onto the filter without a (slow) modulo
+    return (size_t) (((uint64_t) x * self->filterBits) >> 32);
+}
+
+static void
+filterAdd(
+    HandleMgr_t*             self,
+    const HandleMgr_Handle_t h)
+{
+    uint64_t x = hash(h);
+    size_t b1 = filterBit(self, (uint32_t) x);
+    size_t b2 = filterBit(self, (uint32_t) (x >> 32));
+
+    self->filter[b1 / 32] |= (uint32_t) 1 << (b1 % 32);
+    self->filter[b2 / 32] |= (uint32_t) 1 << (b2 % 32);
+}
+
+static bool
+filterMayContain(
+    const HandleMgr_t*       self,
+    const HandleMgr_Handle_t h)
+{
+    uint64_t x;
+    size_t b1, b2;
+
+    if (NULL == self->filter)
+    {
+        return true;
+    }
+
+    x  = hash(h);
+    b1 = filterBit(self, (uint32_t) x);
+    b2 = filterBit(self, (uint32_t) (x >> 32));
+
+    return (self->filter[b1 / 32] >> (b1 % 32)) &
+           (self->filter[b2 / 32] >> (b2 % 32)) & 1;
+}
+
+static void
+filterRebuild(
+    HandleMgr_t* self)
+{
+    size_t sz = PointerVector_getSize(&self->vector);
+
+    if (NULL == self->filter)
+    {
+        return;
+    }
+
+    memset(self->filter, 0, self->filterBits / 8);
+    for (size_t i = 0; i < sz; i++)
+    {
+        filterAdd(self, (HandleMgr_Handle_t)
+                  PointerVector_getElementAt(&self->vector, i));
+    }
+}
+
+static OS_Error_t
+resize(
+    HandleMgr_t* self,
+    size_t       capacity)
+{
+    PointerVector vector;
+    void* buffer;
+    size_t sz = PointerVector_getSize(&self->vector);
+
+    Debug_ASSERT(sz <= capacity);
+
+    if (capacity > MAX_CAPACITY)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+    if ((buffer = self->memFns.alloc(
+                      PointerVector_SIZE_OF_BUFFER(capacity))) == NULL)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+    if (!PointerVector_ctorStatic(&vector, buffer, capacity))
+    {
+        self->memFns.free(buffer);
+        return OS_ERROR_ABORTED;
+    }
+
+    // Keep the order of handles, so there is nothing to rebuild
+    for (size_t i = 0; i < sz; i++)
+    {
+        PointerVector_pushBack(&vector,
+                               PointerVector_getElementAt(&self->vector, i));
+    }
+
+    PointerVector_dtor(&self->vector);
+    self->memFns.free(self->buffer);
+
+    self->vector   = vector;
+    self->buffer   = buffer;
+    self->capacity = capacity;
+
+    return OS_SUCCESS;
+}
+
+static inline uintptr_t
+getKey(
+    PointerVector* v,
+    const size_t   i)
+{
+    return (uintptr_t) PointerVector_getElementAt(v, i);
+}
+
+// Index of the first handle not less than h, or the size of the vector
+static size_t
+lowerBound(
+    PointerVector* v,
+    const HandleMgr_Handle_t h)
+{
+    size_t n = PointerVector_getSize(v);
+    size_t base = 0, half;
+
+    if (0 == n)
+    {
+        return 0;
+    }
+
+    // Halve the range without branching on the comparison, so the compiler can
+    // use a conditional move and there are no mispredictions
+    while (n > 1)
+    {
+        half = n / 2;
+        base = (getKey(v, base + half) < (uintptr_t) h) ? base + half : base;
+        n   -= half;
+    }
+
+    return base + (getKey(v, base) < (uintptr_t) h);
+}
+
+static size_t
+bucketSize(
+    const HandleMgr_t* self)
+{
+    // A table smaller than a bucket is just a single bucket
+    return (self->capacity < HandleMgr_BUCKET_SIZE) ?
+           self->capacity : HandleMgr_BUCKET_SIZE;
+}
+
+// Get the index of the first slot of both buckets a handle may be stored in;
+// a bucket may start at any slot, so the capacity need not be a multiple of
+// the bucket size and all slots can be used
+static void
+getBuckets(
+    const HandleMgr_t*       self,
+    const HandleMgr_Handle_t h,
+    size_t*                  b1,
+    size_t*                  b2)
+{
+    uint64_t n = self->capacity - bucketSize(self) + 1;
+    uint64_t x = hash(h);
+
+    // Map each half of the hash onto the buckets without a (slow) modulo
+    *b1 = (size_t) ((((uint64_t) (uint32_t) x) * n) >> 32);
+    *b2 = (size_t) (((x >> 32) * n) >> 32);
+}
+
+static size_t
+findInBucket(
+    PointerVector*           v,
+    const size_t             b,
+    const size_t             w,
+    const HandleMgr_Handle_t h)
+{
+    for (size_t i = b; i < b + w; i++)
+    {
+        if (h == (HandleMgr_Handle_t) PointerVector_getElementAt(v, i))
+        {
+            return i;
+        }
+    }
+
+    return HANDLE_NOT_FOUND;
+}
+
+// Count the free slots of a bucket and get the index of the first one
+static size_t
+countFree(
     PointerVector* v,
+    const size_t   b,
+    const size_t   w,
+    size_t*        idx)
+{
+    size_t n = 0;
+
+    for (size_t i = b + w; i > b; i--)
+    {
+        if (NULL == PointerVector_getElementAt(v, i - 1))
+        {
+            *idx = i - 1;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+static size_t
+find(
+    HandleMgr_t* self,
     const HandleMgr_Handle_t h)
 {
+    PointerVector* v = &self->vector;
     size_t sz = PointerVector_getSize(v);
+    size_t idx, b1, b2;
+
+    if (HandleMgr_MODE_BOUNDED == self->mode)
+    {
+        getBuckets(self, h, &b1, &b2);
+        idx = findInBucket(v, b1, bucketSize(self), h);
+        return (HANDLE_NOT_FOUND != idx) ?
+               idx : findInBucket(v, b2, bucketSize(self), h);
+    }
+
+    if (HandleMgr_MODE_SORTED == self->mode)
+    {
+        idx = lowerBound(v, h);
+        return (idx < sz && getKey(v, idx) == (uintptr_t) h) ?
+               idx : HANDLE_NOT_FOUND;
+    }
 
     for (size_t i = 0; i < sz; i++)
     {
@@ -35,13 +278,117 @@ find(
     return HANDLE_NOT_FOUND;
 }
 
-// Public functions ------------------------------------------------------------
+// Put a handle (which must not be known yet) into one of its buckets
+static OS_Error_t
+addBounded(
+    HandleMgr_t*             self,
+    const HandleMgr_Handle_t h)
+{
+    PointerVector* v = &self->vector;
+    size_t w = bucketSize(self);
+    size_t b1, b2, i1 = 0, i2 = 0, n1, n2;
 
-OS_Error_t
-HandleMgr_init(HandleMgr_t* self,
-               void* buffer,
-               size_t bufSize,
-               size_t* capacityNumHandles)
+    // Use the emptier bucket, this keeps the buckets balanced so they fill up
+    // much later than with a single choice
+    getBuckets(self, h, &b1, &b2);
+    n1 = countFree(v, b1, w, &i1);
+    n2 = countFree(v, b2, w, &i2);
+    if (0 == n1 && 0 == n2)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    PointerVector_replaceElementAt(v, (n1 >= n2) ? i1 : i2, (Pointer) h);
+
+    return OS_SUCCESS;
+}
+
+static bool
+isEmpty(
+    HandleMgr_t* self)
+{
+    size_t sz = PointerVector_getSize(&self->vector);
+
+    if (HandleMgr_MODE_BOUNDED != self->mode)
+    {
+        return 0 == sz;
+    }
+
+    // The table always has all slots, so look for one in use
+    for (size_t i = 0; i < sz; i++)
+    {
+        if (NULL != PointerVector_getElementAt(&self->vector, i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Swap a handle with the one before it
+static void
+transpose(
+    HandleMgr_t* self,
+    const size_t idx)
+{
+    Pointer h = PointerVector_getElementAt(&self->vector, idx);
+
+    PointerVector_replaceElementAt(
+        &self->vector, idx,
+        PointerVector_getElementAt(&self->vector, idx - 1));
+    PointerVector_replaceElementAt(&self->vector, idx - 1, h);
+}
+
+static int
+compareHandles(
+    const void* a,
+    const void* b)
+{
+    uintptr_t x = (uintptr_t) *(const HandleMgr_Handle_t*) a;
+    uintptr_t y = (uintptr_t) *(const HandleMgr_Handle_t*) b;
+
+    return (x > y) - (x < y);
+}
+
+// Make sure there is room for num more handles, grow the vector if we can
+static OS_Error_t
+reserve(
+    HandleMgr_t* self,
+    const size_t num)
+{
+    size_t sz = PointerVector_getSize(&self->vector);
+    size_t capacity = self->capacity;
+
+    if (num > MAX_CAPACITY - sz)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+    if (sz + num <= capacity)
+    {
+        return OS_SUCCESS;
+    }
+    if (NULL == self->memFns.alloc)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    while (capacity < sz + num)
+    {
+        // Don't overshoot, the last step may be less than doubling
+        capacity = (capacity > MAX_CAPACITY / 2) ? MAX_CAPACITY : capacity * 2;
+    }
+
+    return resize(self, capacity) != OS_SUCCESS ?
+           OS_ERROR_INSUFFICIENT_SPACE : OS_SUCCESS;
+}
+
+static OS_Error_t
+doInit(
+    HandleMgr_t* self,
+    void* buffer,
+    size_t bufSize,
+    size_t* capacityNumHandles)
 {
     if (NULL == self || NULL == buffer || 0 == bufSize)
     {
@@ -60,6 +407,14 @@ HandleMgr_init(HandleMgr_t* self,
         return OS_ERROR_ABORTED;
     }
 
+    self->mode        = HandleMgr_MODE_LINEAR;
+    self->capacity    = myCapacityNumHandles;
+    self->minCapacity = myCapacityNumHandles;
+    self->buffer      = buffer;
+    self->filter      = NULL;
+    self->filterBits  = 0;
+    memset(&self->memFns, 0, sizeof(self->memFns));
+
     if (capacityNumHandles != NULL)
     {
         *capacityNumHandles = myCapacityNumHandles;
@@ -68,8 +423,109 @@ HandleMgr_init(HandleMgr_t* self,
     return OS_SUCCESS;
 }
 
-OS_Error_t
-HandleMgr_free(
+static OS_Error_t
+doInitGrowable(
+    HandleMgr_t* self,
+    const HandleMgr_MemoryFuncs_t* memFns,
+    size_t capacityNumHandles)
+{
+    OS_Error_t err;
+    void* buffer;
+    size_t bufSize;
+
+    if (NULL == self || NULL == memFns || NULL == memFns->alloc ||
+        NULL == memFns->free || 0 == capacityNumHandles)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+    if (capacityNumHandles > MAX_CAPACITY)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    bufSize = PointerVector_SIZE_OF_BUFFER(capacityNumHandles);
+    if ((buffer = memFns->alloc(bufSize)) == NULL)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    if ((err = doInit(self, buffer, bufSize, NULL)) != OS_SUCCESS)
+    {
+        memFns->free(buffer);
+        return err;
+    }
+    self->memFns = *memFns;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+doInitFilter(
+    HandleMgr_t* self,
+    void* buffer,
+    size_t bufSize)
+{
+    if (NULL == self || NULL == buffer || bufSize < sizeof(uint32_t))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (HandleMgr_MODE_BOUNDED == self->mode)
+    {
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    self->filter     = buffer;
+    self->filterBits = (bufSize / sizeof(uint32_t)) * 32;
+
+    filterRebuild(self);
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+doSetMode(
+    HandleMgr_t* self,
+    HandleMgr_Mode_t mode)
+{
+    if (NULL == self || (unsigned int) mode > HandleMgr_MODE_TRANSPOSE)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (!isEmpty(self))
+    {
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    // A bounded table can neither grow nor be filtered
+    if (HandleMgr_MODE_BOUNDED == mode &&
+        (NULL != self->memFns.alloc || NULL != self->filter))
+    {
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    // In bounded mode all slots are always part of the vector and free slots
+    // are NULL, so the table does not need any memory of its own
+    while (PointerVector_getSize(&self->vector) > 0)
+    {
+        PointerVector_popBack(&self->vector);
+    }
+    if (HandleMgr_MODE_BOUNDED == mode)
+    {
+        for (size_t i = 0; i < self->capacity; i++)
+        {
+            PointerVector_pushBack(&self->vector, NULL);
+        }
+    }
+
+    self->mode = mode;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+doFree(
     HandleMgr_t* self)
 {
     if (NULL == self)
@@ -78,12 +534,18 @@ HandleMgr_free(
     }
 
     PointerVector_dtor(&self->vector);
+    if (NULL != self->memFns.free)
+    {
+        self->memFns.free(self->buffer);
+        self->buffer = NULL;
+    }
+    self->filter = NULL;
 
     return OS_SUCCESS;
 }
 
-OS_Error_t
-HandleMgr_add(
+static OS_Error_t
+doAdd(
     HandleMgr_t* self,
     HandleMgr_Handle_t handle)
 {
@@ -92,17 +554,175 @@ HandleMgr_add(
         return OS_ERROR_INVALID_PARAMETER;
     }
 
-    if (find(&self->vector, handle) != HANDLE_NOT_FOUND)
+    if (filterMayContain(self, handle) &&
+        find(self, handle) != HANDLE_NOT_FOUND)
     {
         return OS_ERROR_OPERATION_DENIED;
     }
 
-    return !PointerVector_pushBack(&self->vector, (Pointer) handle) ?
-           OS_ERROR_INSUFFICIENT_SPACE : OS_SUCCESS;
+    if (HandleMgr_MODE_BOUNDED == self->mode)
+    {
+        return addBounded(self, handle);
+    }
+
+    // Grow a full vector, if we can
+    if (reserve(self, 1) != OS_SUCCESS)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    if (!PointerVector_pushBack(&self->vector, (Pointer) handle))
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    if (HandleMgr_MODE_SORTED == self->mode)
+    {
+        // Move all greater handles up by one to make room for the new one
+        size_t idx = lowerBound(&self->vector, handle);
+
+        for (size_t i = PointerVector_getSize(&self->vector) - 1; i > idx; i--)
+        {
+            PointerVector_replaceElementAt(
+                &self->vector, i,
+                PointerVector_getElementAt(&self->vector, i - 1));
+        }
+        PointerVector_replaceElementAt(&self->vector, idx, (Pointer) handle);
+    }
+
+    if (NULL != self->filter)
+    {
+        filterAdd(self, handle);
+    }
+
+    return OS_SUCCESS;
 }
 
-OS_Error_t
-HandleMgr_remove(
+static OS_Error_t
+doAddBatch(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t* handles,
+    size_t numHandles)
+{
+    PointerVector* v;
+    OS_Error_t err;
+    size_t sz, i, j, k;
+
+    if (NULL == self || NULL == handles || 0 == numHandles)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    // Check all handles before anything is added, so it is all or nothing;
+    // with the batch sorted, duplicates within it are next to each other
+    qsort(handles, numHandles, sizeof(HandleMgr_Handle_t), compareHandles);
+    for (i = 0; i < numHandles; i++)
+    {
+        if (NULL == handles[i])
+        {
+            return OS_ERROR_INVALID_PARAMETER;
+        }
+        if ((i > 0 && handles[i] == handles[i - 1]) ||
+            (filterMayContain(self, handles[i]) &&
+             find(self, handles[i]) != HANDLE_NOT_FOUND))
+        {
+            return OS_ERROR_OPERATION_DENIED;
+        }
+    }
+
+    if (HandleMgr_MODE_BOUNDED == self->mode)
+    {
+        // Handles go to different buckets, so add them one by one and take
+        // them out again if one does not fit
+        for (i = 0; i < numHandles; i++)
+        {
+            if ((err = addBounded(self, handles[i])) != OS_SUCCESS)
+            {
+                while (i-- > 0)
+                {
+                    PointerVector_replaceElementAt(&self->vector,
+                                                   find(self, handles[i]),
+                                                   NULL);
+                }
+                return err;
+            }
+        }
+        return OS_SUCCESS;
+    }
+
+    if (reserve(self, numHandles) != OS_SUCCESS)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    v  = &self->vector;
+    sz = PointerVector_getSize(v);
+    for (i = 0; i < numHandles; i++)
+    {
+        if (!PointerVector_pushBack(v, (Pointer) handles[i]))
+        {
+            // Can't happen after reserve(), but undo to be sure
+            while (i-- > 0)
+            {
+                PointerVector_popBack(v);
+            }
+            filterRebuild(self);
+            return OS_ERROR_INSUFFICIENT_SPACE;
+        }
+        if (NULL != self->filter)
+        {
+            filterAdd(self, handles[i]);
+        }
+    }
+
+    if (HandleMgr_MODE_SORTED == self->mode)
+    {
+        // Merge both sorted runs from the back, so every handle is moved at
+        // most once; the batch is read from the (sorted) input array
+        i = sz;
+        j = numHandles;
+        k = sz + numHandles;
+        while (j > 0)
+        {
+            if (i > 0 && getKey(v, i - 1) > (uintptr_t) handles[j - 1])
+            {
+                PointerVector_replaceElementAt(v, --k,
+                                               PointerVector_getElementAt(v, --i));
+            }
+            else
+            {
+                PointerVector_replaceElementAt(v, --k, (Pointer) handles[--j]);
+            }
+        }
+    }
+
+    return OS_SUCCESS;
+}
+
+// Housekeeping after handles were taken out of the vector
+static void
+afterRemove(
+    HandleMgr_t* self)
+{
+    // Bits can't be cleared from a Bloom filter, as they may be shared with
+    // other handles; since we just did a full search anyway, rebuild it
+    filterRebuild(self);
+
+    // Shrink a mostly empty vector, if we can; failing to do so is not an
+    // error, we just keep the memory we have
+    while (NULL != self->memFns.alloc &&
+           self->capacity / 2 >= self->minCapacity &&
+           PointerVector_getSize(&self->vector) < self->capacity / 4)
+    {
+        if (resize(self, self->capacity / 2) != OS_SUCCESS)
+        {
+            break;
+        }
+    }
+}
+
+static OS_Error_t
+doRemove(
     HandleMgr_t* self,
     HandleMgr_Handle_t handle)
 {
@@ -113,29 +733,304 @@ HandleMgr_remove(
         return OS_ERROR_INVALID_PARAMETER;
     }
 
-    if ((idx = find(&self->vector, handle)) ==  HANDLE_NOT_FOUND)
+    if ((idx = find(self, handle)) ==  HANDLE_NOT_FOUND)
     {
         return OS_ERROR_INVALID_HANDLE;
     }
 
-    PointerVector_replaceElementAt(&self->vector,
-                                   idx,
-                                   PointerVector_getBack(&self->vector));
+    if (HandleMgr_MODE_BOUNDED == self->mode)
+    {
+        // Just free the slot; there is no filter and nothing to shrink
+        PointerVector_replaceElementAt(&self->vector, idx, NULL);
+        return OS_SUCCESS;
+    }
+
+    if (HandleMgr_MODE_SORTED == self->mode ||
+        HandleMgr_MODE_TRANSPOSE == self->mode)
+    {
+        // Move all following handles down by one to keep the order
+        size_t sz = PointerVector_getSize(&self->vector);
+
+        for (size_t i = idx + 1; i < sz; i++)
+        {
+            PointerVector_replaceElementAt(
+                &self->vector, i - 1,
+                PointerVector_getElementAt(&self->vector, i));
+        }
+    }
+    else
+    {
+        PointerVector_replaceElementAt(&self->vector,
+                                       idx,
+                                       PointerVector_getBack(&self->vector));
+    }
     PointerVector_popBack(&self->vector);
 
+    afterRemove(self);
+
     return OS_SUCCESS;
 }
 
-HandleMgr_Handle_t
-HandleMgr_validate(
+static OS_Error_t
+doRemoveBatch(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t* handles,
+    size_t numHandles)
+{
+    PointerVector* v;
+    Pointer h;
+    bool found;
+    size_t sz, i, j, k;
+
+    if (NULL == self || NULL == handles || 0 == numHandles)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    // Check all handles before anything is removed, so it is all or nothing;
+    // with the batch sorted, duplicates within it are next to each other
+    qsort(handles, numHandles, sizeof(HandleMgr_Handle_t), compareHandles);
+    for (i = 0; i < numHandles; i++)
+    {
+        if (NULL == handles[i])
+        {
+            return OS_ERROR_INVALID_PARAMETER;
+        }
+        if ((i > 0 && handles[i] == handles[i - 1]) ||
+            !filterMayContain(self, handles[i]) ||
+            find(self, handles[i]) == HANDLE_NOT_FOUND)
+        {
+            return OS_ERROR_INVALID_HANDLE;
+        }
+    }
+
+    v = &self->vector;
+
+    if (HandleMgr_MODE_BOUNDED == self->mode)
+    {
+        for (i = 0; i < numHandles; i++)
+        {
+            PointerVector_replaceElementAt(v, find(self, handles[i]), NULL);
+        }
+        return OS_SUCCESS;
+    }
+
+    // Move every remaining handle at most once, keeping their order; in sorted
+    // mode, the handles before the first one to remove stay where they are and
+    // the rest is merged with the (sorted) batch, otherwise the batch is
+    // searched for every handle
+    sz = PointerVector_getSize(v);
+    i  = (HandleMgr_MODE_SORTED == self->mode) ? lowerBound(v, handles[0]) : 0;
+    for (j = 0, k = i; i < sz; i++)
+    {
+        h = PointerVector_getElementAt(v, i);
+        if (HandleMgr_MODE_SORTED == self->mode)
+        {
+            found = (j < numHandles && h == handles[j]);
+            j    += found;
+        }
+        else
+        {
+            found = bsearch(&h, handles, numHandles, sizeof(HandleMgr_Handle_t),
+                            compareHandles) != NULL;
+        }
+        if (!found)
+        {
+            PointerVector_replaceElementAt(v, k++, h);
+        }
+    }
+    while (PointerVector_getSize(v) > k)
+    {
+        PointerVector_popBack(v);
+    }
+
+    afterRemove(self);
+
+    return OS_SUCCESS;
+}
+
+static HandleMgr_Handle_t
+doValidate(
     HandleMgr_t* self,
     HandleMgr_Handle_t handle)
 {
+    size_t idx;
+
     // Let NULL pointers simply pass through
     if (NULL == self || NULL == handle)
     {
         return NULL;
     }
 
-    return find(&self->vector, handle) != HANDLE_NOT_FOUND ? handle : NULL;
+    // Reject unknown handles early, if we have a filter
+    if (!filterMayContain(self, handle))
+    {
+        return NULL;
+    }
+
+    if ((idx = find(self, handle)) == HANDLE_NOT_FOUND)
+    {
+        return NULL;
+    }
+
+    if (HandleMgr_MODE_TRANSPOSE == self->mode && idx > 0)
+    {
+        // Let the handle move up by one step on every hit, so frequently used
+        // handles end up at the front; unlike moving it to the front right
+        // away, this costs no more than a swap and a rarely used handle can't
+        // push the frequently used ones back
+        transpose(self, idx);
+    }
+
+    return handle;
+}
+
+// Public functions ------------------------------------------------------------
+
+OS_Error_t
+HandleMgr_init(
+    HandleMgr_t* self,
+    void* buffer,
+    size_t bufSize,
+    size_t* capacityNumHandles)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doInit(self, buffer, bufSize, capacityNumHandles);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_INIT, self, bufSize, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_initGrowable(
+    HandleMgr_t* self,
+    const HandleMgr_MemoryFuncs_t* memFns,
+    size_t capacityNumHandles)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doInitGrowable(self, memFns, capacityNumHandles);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_INIT_GROWABLE, self,
+                    capacityNumHandles, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_initFilter(
+    HandleMgr_t* self,
+    void* buffer,
+    size_t bufSize)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doInitFilter(self, buffer, bufSize);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_INIT_FILTER, self, bufSize, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_setMode(
+    HandleMgr_t* self,
+    HandleMgr_Mode_t mode)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doSetMode(self, mode);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_SET_MODE, self, mode, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_free(
+    HandleMgr_t* self)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doFree(self);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_FREE, self, 0, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_add(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t handle)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doAdd(self, handle);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_ADD, self, handle, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_addBatch(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t* handles,
+    size_t numHandles)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doAddBatch(self, handles, numHandles);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_ADD_BATCH, self, numHandles, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_remove(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t handle)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doRemove(self, handle);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_REMOVE, self, handle, err);
+
+    return err;
+}
+
+OS_Error_t
+HandleMgr_removeBatch(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t* handles,
+    size_t numHandles)
+{
+    OS_Error_t err;
+    ServerTrace_BEGIN(t);
+
+    err = doRemoveBatch(self, handles, numHandles);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_REMOVE_BATCH, self, numHandles,
+                    err);
+
+    return err;
+}
+
+HandleMgr_Handle_t
+HandleMgr_validate(
+    HandleMgr_t* self,
+    HandleMgr_Handle_t handle)
+{
+    HandleMgr_Handle_t ret;
+    ServerTrace_BEGIN(t);
+
+    ret = doValidate(self, handle);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_VALIDATE, self, handle,
+                    (NULL != ret) ? OS_SUCCESS : OS_ERROR_INVALID_HANDLE);
+
+    return ret;
 }
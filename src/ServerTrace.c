@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "lib_debug/Debug.h"
+#include "lib_server/ServerTrace.h"
+
+#include <stdbool.h>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+// We wrap around by masking the index
+Debug_STATIC_ASSERT((LIB_SERVER_TRACE_EVENTS &
+                     (LIB_SERVER_TRACE_EVENTS - 1)) == 0);
+
+// Ring buffer of a single thread; only the owning thread writes to it
+typedef struct
+{
+    size_t head;
+    ServerTrace_Event_t events[LIB_SERVER_TRACE_EVENTS];
+} Ring_t;
+
+static Ring_t rings[LIB_SERVER_TRACE_THREADS];
+static size_t numRings;
+static size_t numDropped;
+// Incremented whenever ServerTrace_reset() takes all rings back
+static size_t generation;
+
+// Index of the ring of the calling thread plus one, zero if it has none yet,
+// and the generation it was claimed in; rings of older generations are void
+static __thread size_t myRing;
+static __thread size_t myGeneration;
+
+#if defined(__linux__)
+static uint64_t
+monotonicNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+static ServerTrace_ClockFunc_t clockFn = monotonicNs;
+#else
+static ServerTrace_ClockFunc_t clockFn = NULL;
+#endif
+
+static const char* const opNames[ServerTrace_NUM_OPS] =
+{
+    [ServerTrace_CONTEXTMGR_INIT]           = "ContextMgr_init",
+    [ServerTrace_CONTEXTMGR_INIT_BOUNDED]   = "ContextMgr_initBounded",
+    [ServerTrace_CONTEXTMGR_FREE]           = "ContextMgr_free",
+    [ServerTrace_CONTEXTMGR_GET]            = "ContextMgr_get",
+    [ServerTrace_CONTEXTMGR_ALLOC]          = "ContextMgr_alloc",
+    [ServerTrace_HANDLEMGR_INIT]            = "HandleMgr_init",
+    [ServerTrace_HANDLEMGR_INIT_GROWABLE]   = "HandleMgr_initGrowable",
+    [ServerTrace_HANDLEMGR_INIT_FILTER]     = "HandleMgr_initFilter",
+    [ServerTrace_HANDLEMGR_SET_MODE]        = "HandleMgr_setMode",
+    [ServerTrace_HANDLEMGR_FREE]            = "HandleMgr_free",
+    [ServerTrace_HANDLEMGR_ADD]             = "HandleMgr_add",
+    [ServerTrace_HANDLEMGR_ADD_BATCH]       = "HandleMgr_addBatch",
+    [ServerTrace_HANDLEMGR_REMOVE]          = "HandleMgr_remove",
+    [ServerTrace_HANDLEMGR_REMOVE_BATCH]    = "HandleMgr_removeBatch",
+    [ServerTrace_HANDLEMGR_VALIDATE]        = "HandleMgr_validate",
+};
+
+// Private functions -----------------------------------------------------------
+
+static Ring_t*
+getRing(void)
+{
+    size_t idx, gen = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+
+    if (myRing > 0 && myGeneration == gen)
+    {
+        return &rings[myRing - 1];
+    }
+
+    // Claim the next free ring, without ever going past the end of the pool
+    idx = __atomic_load_n(&numRings, __ATOMIC_RELAXED);
+    do
+    {
+        if (idx >= LIB_SERVER_TRACE_THREADS)
+        {
+            return NULL;
+        }
+    }
+    while (!__atomic_compare_exchange_n(&numRings, &idx, idx + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    myRing       = idx + 1;
+    myGeneration = gen;
+
+    return &rings[idx];
+}
+
+// Public functions ------------------------------------------------------------
+
+void
+ServerTrace_setClock(
+    ServerTrace_ClockFunc_t clock)
+{
+    __atomic_store_n(&clockFn, clock, __ATOMIC_RELAXED);
+}
+
+uint64_t
+ServerTrace_now(void)
+{
+    ServerTrace_ClockFunc_t fn = __atomic_load_n(&clockFn, __ATOMIC_RELAXED);
+
+    return (NULL != fn) ? fn() : 0;
+}
+
+void
+ServerTrace_record(
+    ServerTrace_Op_t op,
+    const void*      self,
+    uintptr_t        arg,
+    OS_Error_t       result,
+    uint64_t         start)
+{
+    Ring_t* ring;
+    ServerTrace_Event_t* ev;
+    size_t head;
+
+    if ((ring = getRing()) == NULL)
+    {
+        __atomic_add_fetch(&numDropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    head = ring->head;
+    ev   = &ring->events[head & (LIB_SERVER_TRACE_EVENTS - 1)];
+
+    ev->start    = start;
+    ev->duration = ServerTrace_now() - start;
+    ev->self     = self;
+    ev->arg      = arg;
+    ev->result   = result;
+    ev->op       = (uint16_t) op;
+
+    // Publish the event only once it is complete
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void
+ServerTrace_dump(
+    ServerTrace_DumpFunc_t fn,
+    void*                  ctx)
+{
+    size_t n, head, first;
+
+    if (NULL == fn)
+    {
+        return;
+    }
+
+    n = __atomic_load_n(&numRings, __ATOMIC_ACQUIRE);
+    for (size_t t = 0; t < n; t++)
+    {
+        head  = __atomic_load_n(&rings[t].head, __ATOMIC_ACQUIRE);
+        first = (head > LIB_SERVER_TRACE_EVENTS) ?
+                head - LIB_SERVER_TRACE_EVENTS : 0;
+        for (size_t i = first; i < head; i++)
+        {
+            fn(t, &rings[t].events[i & (LIB_SERVER_TRACE_EVENTS - 1)], ctx);
+        }
+    }
+}
+
+void
+ServerTrace_reset(void)
+{
+    size_t n = __atomic_load_n(&numRings, __ATOMIC_ACQUIRE);
+
+    for (size_t t = 0; t < n; t++)
+    {
+        __atomic_store_n(&rings[t].head, 0, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&numDropped, 0, __ATOMIC_RELAXED);
+
+    // Take all rings back, threads which trace again claim a new one
+    __atomic_store_n(&numRings, 0, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+}
+
+size_t
+ServerTrace_getDropped(void)
+{
+    return __atomic_load_n(&numDropped, __ATOMIC_RELAXED);
+}
+
+const char*
+ServerTrace_getOpName(
+    ServerTrace_Op_t op)
+{
+    return ((unsigned) op < ServerTrace_NUM_OPS) ? opNames[op] : "unknown";
+}
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "lib_debug/Debug.h"
+#include "lib_server/SessionMgr.h"
+#include "lib_macros/Check.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Same limits as for the ContextMgr
+#define SESSIONMGR_CLIENTS_MIN 1
+#define SESSIONMGR_CLIENTS_MAX 1024
+#define SESSIONMGR_HANDLES_MIN 1
+#define SESSIONMGR_HANDLES_MAX 1024
+
+// Client slot; the memory for the handles directly follows the slot
+struct SessionMgr_ClientSlot
+{
+    void* mem;
+    size_t count;
+    size_t quota;
+    HandleMgr_t handles;
+};
+
+#define INVALID_SLOT ((size_t) -1)
+
+// As the handles follow the slot, the slot size must keep them aligned
+Debug_STATIC_ASSERT(sizeof(SessionMgr_ClientSlot_t) % sizeof(void*) == 0);
+
+// Private functions -----------------------------------------------------------
+
+static SessionMgr_ClientSlot_t*
+getSlot(
+    SessionMgr_t* self,
+    const size_t  idx)
+{
+    return (SessionMgr_ClientSlot_t*) ((uint8_t*) self->slots +
+                                       idx * self->slotSize);
+}
+
+static size_t
+find(
+    SessionMgr_t*          self,
+    const ContextMgr_CID_t cid)
+{
+    // Slots are handed out in order and never given back, so only the used
+    // ones need to be searched
+    for (size_t i = 0; i < self->used; i++)
+    {
+        if (self->cids[i] == cid)
+        {
+            return i;
+        }
+    }
+
+    return INVALID_SLOT;
+}
+
+static OS_Error_t
+findOrAlloc(
+    SessionMgr_t*             self,
+    const ContextMgr_CID_t    cid,
+    SessionMgr_ClientSlot_t** slot)
+{
+    OS_Error_t err;
+    size_t idx;
+    SessionMgr_ClientSlot_t* s;
+
+    if ((idx = find(self, cid)) != INVALID_SLOT)
+    {
+        *slot = getSlot(self, idx);
+        return OS_SUCCESS;
+    }
+
+    if (self->used == self->max)
+    {
+        Debug_LOG_ERROR("Could not find free session slot for client " \
+                        "(CID=%i)", cid);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    s = getSlot(self, self->used);
+    if ((err = HandleMgr_init(&s->handles, s + 1,
+                              HandleMgr_SIZE_OF_BUFFER(self->maxHandles),
+                              NULL)) != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("HandleMgr_init() failed on client (CID=%i) " \
+                        "with %d", cid, err);
+        return err;
+    }
+    if ((err = self->memFns.init(cid, &s->mem)) != OS_SUCCESS)
+    {
+        Debug_LOG_ERROR("init() callback failed on client (CID=%i) " \
+                        "with %d", cid, err);
+        HandleMgr_free(&s->handles);
+        return err;
+    }
+
+    s->count = 0;
+    s->quota = self->maxHandles;
+
+    self->cids[self->used++] = cid;
+    *slot = s;
+
+    return OS_SUCCESS;
+}
+
+// Public functions ------------------------------------------------------------
+
+OS_Error_t
+SessionMgr_init(
+    SessionMgr_t*                   self,
+    const ContextMgr_MemoryFuncs_t* memFns,
+    const size_t                    max,
+    const size_t                    maxHandles)
+{
+    CHECK_PTR_NOT_NULL(self);
+    CHECK_PTR_NOT_NULL(memFns);
+    CHECK_PTR_NOT_NULL(memFns->init);
+    CHECK_PTR_NOT_NULL(memFns->free);
+    CHECK_VALUE_IN_CLOSED_INTERVAL(max,
+                                   SESSIONMGR_CLIENTS_MIN,
+                                   SESSIONMGR_CLIENTS_MAX);
+    CHECK_VALUE_IN_CLOSED_INTERVAL(maxHandles,
+                                   SESSIONMGR_HANDLES_MIN,
+                                   SESSIONMGR_HANDLES_MAX);
+
+    self->memFns     = *memFns;
+    self->max        = max;
+    self->used       = 0;
+    self->maxHandles = maxHandles;
+    self->slotSize   = sizeof(SessionMgr_ClientSlot_t) +
+                       HandleMgr_SIZE_OF_BUFFER(maxHandles);
+
+    if ((self->cids = calloc(max, sizeof(ContextMgr_CID_t))) == NULL)
+    {
+        Debug_LOG_ERROR("calloc() failed");
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+    if ((self->slots = calloc(max, self->slotSize)) == NULL)
+    {
+        Debug_LOG_ERROR("calloc() failed");
+        free(self->cids);
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SessionMgr_free(
+    SessionMgr_t* self)
+{
+    OS_Error_t err;
+    SessionMgr_ClientSlot_t* slot;
+
+    CHECK_PTR_NOT_NULL(self);
+
+    for (size_t i = 0; i < self->used; i++)
+    {
+        slot = getSlot(self, i);
+        if ((err = self->memFns.free(self->cids[i], slot->mem)) != OS_SUCCESS)
+        {
+            Debug_LOG_ERROR("free() callback failed on client (CID=%i) " \
+                            "with %d, continuing", self->cids[i], err);
+        }
+        HandleMgr_free(&slot->handles);
+    }
+    self->used = 0;
+
+    free(self->slots);
+    free(self->cids);
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SessionMgr_get(
+    SessionMgr_t*          self,
+    const ContextMgr_CID_t cid,
+    void**                 ctx)
+{
+    OS_Error_t err;
+    SessionMgr_ClientSlot_t* slot;
+
+    CHECK_PTR_NOT_NULL(self);
+    CHECK_PTR_NOT_NULL(ctx);
+
+    if ((err = findOrAlloc(self, cid, &slot)) != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    *ctx = slot->mem;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SessionMgr_addHandle(
+    SessionMgr_t*            self,
+    const ContextMgr_CID_t   cid,
+    const HandleMgr_Handle_t handle)
+{
+    OS_Error_t err;
+    SessionMgr_ClientSlot_t* slot;
+
+    CHECK_PTR_NOT_NULL(self);
+    CHECK_PTR_NOT_NULL(handle);
+
+    if ((err = findOrAlloc(self, cid, &slot)) != OS_SUCCESS)
+    {
+        return err;
+    }
+    if (slot->count >= slot->quota)
+    {
+        // Report duplicates the same way the HandleMgr does
+        return (HandleMgr_validate(&slot->handles, handle) != NULL) ?
+               OS_ERROR_OPERATION_DENIED : OS_ERROR_INSUFFICIENT_SPACE;
+    }
+    if ((err = HandleMgr_add(&slot->handles, handle)) != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    slot->count++;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SessionMgr_removeHandle(
+    SessionMgr_t*            self,
+    const ContextMgr_CID_t   cid,
+    const HandleMgr_Handle_t handle)
+{
+    OS_Error_t err;
+    SessionMgr_ClientSlot_t* slot;
+    size_t idx;
+
+    CHECK_PTR_NOT_NULL(self);
+    CHECK_PTR_NOT_NULL(handle);
+
+    if ((idx = find(self, cid)) == INVALID_SLOT)
+    {
+        return OS_ERROR_INVALID_HANDLE;
+    }
+
+    slot = getSlot(self, idx);
+    if ((err = HandleMgr_remove(&slot->handles, handle)) != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    slot->count--;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SessionMgr_setQuota(
+    SessionMgr_t*          self,
+    const ContextMgr_CID_t cid,
+    const size_t           quota)
+{
+    OS_Error_t err;
+    SessionMgr_ClientSlot_t* slot;
+
+    CHECK_PTR_NOT_NULL(self);
+
+    if (quota > self->maxHandles)
+    {
+        Debug_LOG_ERROR("Quota of %zu exceeds max number of handles (%zu)",
+                        quota, self->maxHandles);
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if ((err = findOrAlloc(self, cid, &slot)) != OS_SUCCESS)
+    {
+        return err;
+    }
+
+    // Lowering the quota below the current count does not take handles away,
+    // the client just cannot add new ones until it is below the quota again
+    slot->quota = quota;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SessionMgr_getCount(
+    SessionMgr_t*          self,
+    const ContextMgr_CID_t cid,
+    size_t*                count)
+{
+    size_t idx;
+
+    CHECK_PTR_NOT_NULL(self);
+    CHECK_PTR_NOT_NULL(count);
+
+    idx = find(self, cid);
+    *count = (idx == INVALID_SLOT) ? 0 : getSlot(self, idx)->count;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SessionMgr_resolve(
+    SessionMgr_t*            self,
+    const ContextMgr_CID_t   cid,
+    const HandleMgr_Handle_t handle,
+    void**                   ctx)
+{
+    SessionMgr_ClientSlot_t* slot;
+    size_t idx;
+
+    CHECK_PTR_NOT_NULL(self);
+    CHECK_PTR_NOT_NULL(handle);
+    CHECK_PTR_NOT_NULL(ctx);
+
+    if ((idx = find(self, cid)) == INVALID_SLOT)
+    {
+        return OS_ERROR_INVALID_HANDLE;
+    }
+
+    slot = getSlot(self, idx);
+    if (HandleMgr_validate(&slot->handles, handle) == NULL)
+    {
+        return OS_ERROR_INVALID_HANDLE;
+    }
+
+    *ctx = slot->mem;
+
+    return OS_SUCCESS;
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include "lib_debug/Debug.h"
+#include "lib_server/SharedHandleMgr.h"
+
+// "LSHM" in little endian, marks a region which is ready to be attached to
+#define REGION_MAGIC    0x4d48534cu
+
+// How often a reader retries a lookup which overlapped with an update
+#define MAX_RETRIES     1024
+// How long a reader spins while an update is in progress before it yields,
+// and how often it yields (if it can) before it assumes the writer is stuck
+#define MAX_SPINS       1024
+#define MAX_YIELDS      64
+
+#define HANDLE_NOT_FOUND ((size_t) -1)
+
+// Handles are stored as 64 bit values, regardless of the pointer size
+Debug_STATIC_ASSERT(sizeof(HandleMgr_Handle_t) <= sizeof(uint64_t));
+// The handles directly follow the header and must be aligned
+Debug_STATIC_ASSERT(sizeof(SharedHandleMgr_Region_t) % sizeof(uint64_t) == 0);
+
+// Private functions -----------------------------------------------------------
+
+// All accesses to shared data are atomic, as readers access it concurrently;
+// relaxed is enough, the ordering is established by the sequence counter
+static inline uint64_t
+loadHandle(
+    const SharedHandleMgr_t* self,
+    const size_t             i)
+{
+    return __atomic_load_n(&self->handles[i], __ATOMIC_RELAXED);
+}
+
+static inline void
+storeHandle(
+    SharedHandleMgr_t* self,
+    const size_t       i,
+    const uint64_t     h)
+{
+    __atomic_store_n(&self->handles[i], h, __ATOMIC_RELAXED);
+}
+
+// Index of the first handle not less than h, or count
+static size_t
+lowerBound(
+    const SharedHandleMgr_t* self,
+    const size_t             count,
+    const uint64_t           h)
+{
+    size_t n = count;
+    size_t base = 0, half;
+
+    if (0 == n)
+    {
+        return 0;
+    }
+
+    while (n > 1)
+    {
+        half = n / 2;
+        base = (loadHandle(self, base + half) < h) ? base + half : base;
+        n   -= half;
+    }
+
+    return base + (loadHandle(self, base) < h);
+}
+
+static size_t
+find(
+    const SharedHandleMgr_t* self,
+    const size_t             count,
+    const uint64_t           h)
+{
+    size_t idx = lowerBound(self, count, h);
+
+    return (idx < count && loadHandle(self, idx) == h) ? idx : HANDLE_NOT_FOUND;
+}
+
+static size_t
+getCount(
+    const SharedHandleMgr_t* self)
+{
+    uint64_t count = __atomic_load_n(&self->region->count, __ATOMIC_RELAXED);
+
+    // Never trust the region more than needed
+    return (count > self->capacity) ? self->capacity : (size_t) count;
+}
+
+static void
+writeBegin(
+    SharedHandleMgr_t* self)
+{
+    uint32_t seq = __atomic_load_n(&self->region->seq, __ATOMIC_RELAXED);
+
+    // An odd sequence tells readers that the data is being changed
+    __atomic_store_n(&self->region->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void
+writeEnd(
+    SharedHandleMgr_t* self)
+{
+    uint32_t seq = __atomic_load_n(&self->region->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&self->region->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+static inline void
+cpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ volatile("yield");
+#endif
+}
+
+// Wait a little for the writer to finish its update; spin with an increasing
+// number of pauses first, as updates are short, then give the CPU away if the
+// user told us how, as the writer may need it to get done. Returns false if
+// the writer takes so long it is most likely stuck.
+static bool
+waitForWriter(
+    const SharedHandleMgr_t* self,
+    size_t*                  spins,
+    size_t*                  yields)
+{
+    if (*spins < MAX_SPINS)
+    {
+        for (size_t i = 0; i <= *spins; i++)
+        {
+            cpuRelax();
+        }
+        *spins = 2 * *spins + 1;
+        return true;
+    }
+    if (NULL != self->yieldFn && *yields < MAX_YIELDS)
+    {
+        (*yields)++;
+        self->yieldFn();
+        return true;
+    }
+
+    return false;
+}
+
+// Public functions ------------------------------------------------------------
+
+OS_Error_t
+SharedHandleMgr_init(
+    SharedHandleMgr_t* self,
+    void* region,
+    size_t regionSize,
+    size_t* capacityNumHandles)
+{
+    SharedHandleMgr_Region_t* r = region;
+    size_t myCapacityNumHandles;
+
+    if (NULL == self || NULL == region ||
+        ((uintptr_t) region % sizeof(uint64_t)) != 0 ||
+        regionSize < SharedHandleMgr_SIZE_OF_REGION(1))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    myCapacityNumHandles = (regionSize - sizeof(SharedHandleMgr_Region_t)) /
+                           sizeof(uint64_t);
+    if (capacityNumHandles != NULL &&
+        *capacityNumHandles > myCapacityNumHandles)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    // Invalidate the region first, so nobody attaches to a half-formatted one
+    __atomic_store_n(&r->magic, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&r->seq, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&r->capacity, myCapacityNumHandles, __ATOMIC_RELAXED);
+    __atomic_store_n(&r->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&r->handlesOffset, sizeof(SharedHandleMgr_Region_t),
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&r->magic, REGION_MAGIC, __ATOMIC_RELEASE);
+
+    self->region   = r;
+    self->handles  = (uint64_t*) ((uint8_t*) r + sizeof(*r));
+    self->capacity = myCapacityNumHandles;
+    self->isWriter = true;
+    self->yieldFn  = NULL;
+    self->stuckSeq = 0;
+
+    if (capacityNumHandles != NULL)
+    {
+        *capacityNumHandles = myCapacityNumHandles;
+    }
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SharedHandleMgr_attach(
+    SharedHandleMgr_t* self,
+    const void* region,
+    size_t regionSize,
+    SharedHandleMgr_YieldFunc_t yieldFn)
+{
+    SharedHandleMgr_Region_t* r = (SharedHandleMgr_Region_t*) region;
+    uint64_t capacity, offset;
+
+    if (NULL == self || NULL == region ||
+        ((uintptr_t) region % sizeof(uint64_t)) != 0 ||
+        regionSize < SharedHandleMgr_SIZE_OF_REGION(1))
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    if (__atomic_load_n(&r->magic, __ATOMIC_ACQUIRE) != REGION_MAGIC)
+    {
+        Debug_LOG_ERROR("Region was not initialized by writer");
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    // Capacity and offset never change after init, so check them once and use
+    // our own copy from now on
+    capacity = __atomic_load_n(&r->capacity, __ATOMIC_RELAXED);
+    offset   = __atomic_load_n(&r->handlesOffset, __ATOMIC_RELAXED);
+    if (offset < sizeof(SharedHandleMgr_Region_t) ||
+        (offset % sizeof(uint64_t)) != 0 ||
+        offset > regionSize ||
+        capacity > (regionSize - offset) / sizeof(uint64_t))
+    {
+        Debug_LOG_ERROR("Region layout does not fit into %zu bytes",
+                        regionSize);
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    self->region   = r;
+    self->handles  = (uint64_t*) ((uint8_t*) r + offset);
+    self->capacity = (size_t) capacity;
+    self->isWriter = false;
+    self->yieldFn  = yieldFn;
+    self->stuckSeq = 0;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SharedHandleMgr_free(
+    SharedHandleMgr_t* self)
+{
+    if (NULL == self)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+
+    self->region   = NULL;
+    self->handles  = NULL;
+    self->capacity = 0;
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SharedHandleMgr_add(
+    SharedHandleMgr_t* self,
+    HandleMgr_Handle_t handle)
+{
+    uint64_t h = (uint64_t) (uintptr_t) handle;
+    size_t count, idx;
+
+    if (NULL == self || NULL == handle)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+    if (!self->isWriter)
+    {
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    // Being the only writer, we can look at the data without the seqlock
+    count = getCount(self);
+    idx   = lowerBound(self, count, h);
+    if (idx < count && loadHandle(self, idx) == h)
+    {
+        return OS_ERROR_OPERATION_DENIED;
+    }
+    if (count == self->capacity)
+    {
+        return OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    writeBegin(self);
+    for (size_t i = count; i > idx; i--)
+    {
+        storeHandle(self, i, loadHandle(self, i - 1));
+    }
+    storeHandle(self, idx, h);
+    __atomic_store_n(&self->region->count, count + 1, __ATOMIC_RELAXED);
+    writeEnd(self);
+
+    return OS_SUCCESS;
+}
+
+OS_Error_t
+SharedHandleMgr_remove(
+    SharedHandleMgr_t* self,
+    HandleMgr_Handle_t handle)
+{
+    uint64_t h = (uint64_t) (uintptr_t) handle;
+    size_t count, idx;
+
+    if (NULL == self || NULL == handle)
+    {
+        return OS_ERROR_INVALID_PARAMETER;
+    }
+    if (!self->isWriter)
+    {
+        return OS_ERROR_INVALID_STATE;
+    }
+
+    count = getCount(self);
+    if ((idx = find(self, count, h)) == HANDLE_NOT_FOUND)
+    {
+        return OS_ERROR_INVALID_HANDLE;
+    }
+
+    writeBegin(self);
+    for (size_t i = idx + 1; i < count; i++)
+    {
+        storeHandle(self, i - 1, loadHandle(self, i));
+    }
+    __atomic_store_n(&self->region->count, count - 1, __ATOMIC_RELAXED);
+    writeEnd(self);
+
+    return OS_SUCCESS;
+}
+
+HandleMgr_Handle_t
+SharedHandleMgr_validate(
+    SharedHandleMgr_t* self,
+    HandleMgr_Handle_t handle)
+{
+    uint64_t h = (uint64_t) (uintptr_t) handle;
+    uint32_t seq;
+    size_t idx, retries = 0, spins = 0, yields = 0;
+
+    // Let NULL pointers simply pass through
+    if (NULL == self || NULL == self->region || NULL == handle)
+    {
+        return NULL;
+    }
+
+    if (self->isWriter)
+    {
+        return find(self, getCount(self), h) != HANDLE_NOT_FOUND ?
+               handle : NULL;
+    }
+
+    while (retries < MAX_RETRIES)
+    {
+        seq = __atomic_load_n(&self->region->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+        {
+            // If an earlier lookup already gave up on this very update, the
+            // writer is still stuck in it; fail right away instead of making
+            // every lookup wait for it again
+            if (__atomic_load_n(&self->stuckSeq, __ATOMIC_RELAXED) == seq)
+            {
+                return NULL;
+            }
+            // An update in progress is not a failed lookup, so just wait for
+            // it instead of using up a retry
+            if (!waitForWriter(self, &spins, &yields))
+            {
+                Debug_LOG_WARNING("Gave up waiting for writer");
+                __atomic_store_n(&self->stuckSeq, seq, __ATOMIC_RELAXED);
+                return NULL;
+            }
+            continue;
+        }
+
+        // The data may change under our feet, but all indices are bounded by
+        // our own capacity, so the worst case is a wrong result, which is
+        // discarded below
+        idx = find(self, getCount(self), h);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&self->region->seq, __ATOMIC_RELAXED) == seq)
+        {
+            return idx != HANDLE_NOT_FOUND ? handle : NULL;
+        }
+
+        retries++;
+    }
+
+    Debug_LOG_WARNING("Gave up validating handle after %d retries",
+                      MAX_RETRIES);
+
+    return NULL;
+}
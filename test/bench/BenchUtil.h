@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief Helpers shared by the lib_server microbenchmarks
+ */
+
+#pragma once
+
+extern "C"
+{
+#include "lib_server/ContextMgr.h"
+#include "lib_server/HandleMgr.h"
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench
+{
+
+/**
+ * How lookups are spread over the items of a table
+ */
+enum Distribution
+{
+    DIST_DENSE  = 0,    ///< round-robin over all items
+    DIST_RANDOM = 1,    ///< uniformly random
+    DIST_ZIPF   = 2,    ///< Zipf (s = 1), i.e. few items get most lookups
+};
+
+static const char* const distributionNames[] = { "dense", "random", "zipf" };
+
+// Length of the precomputed index sequences; a power of two, so benchmarks
+// can cycle through them with a cheap mask
+static const size_t SEQUENCE_LEN = 4096;
+
+/**
+ * Precompute a sequence of item indices in [0, n), so that drawing random
+ * numbers does not show up in the measured time.
+ */
+static inline std::vector<size_t>
+makeSequence(
+    Distribution dist,
+    size_t       n,
+    uint32_t     seed = 42)
+{
+    std::vector<size_t> seq(SEQUENCE_LEN);
+    std::mt19937 rng(seed);
+
+    switch (dist)
+    {
+    case DIST_DENSE:
+        for (size_t i = 0; i < SEQUENCE_LEN; i++)
+        {
+            seq[i] = i % n;
+        }
+        break;
+    case DIST_RANDOM:
+    {
+        std::uniform_int_distribution<size_t> uni(0, n - 1);
+        for (size_t i = 0; i < SEQUENCE_LEN; i++)
+        {
+            seq[i] = uni(rng);
+        }
+        break;
+    }
+    case DIST_ZIPF:
+    {
+        // Sample from the CDF; the hottest items are spread over the table
+        // via a random permutation, so they are not simply the first ones
+        std::vector<double> cdf(n);
+        std::vector<size_t> perm(n);
+        std::uniform_real_distribution<double> uni(0.0, 1.0);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            sum += 1.0 / static_cast<double>(i + 1);
+            cdf[i] = sum;
+            perm[i] = i;
+        }
+        std::shuffle(perm.begin(), perm.end(), rng);
+        for (size_t i = 0; i < SEQUENCE_LEN; i++)
+        {
+            double u = uni(rng) * sum;
+            size_t k = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+            seq[i] = perm[std::min(k, n - 1)];
+        }
+        break;
+    }
+    }
+
+    return seq;
+}
+
+/**
+ * Read the cycle counter; on architectures without one which is accessible
+ * from user space, a (fixed frequency) timer or clock is used instead.
+ */
+static inline uint64_t
+readCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Largest number of handles and client contexts the benchmarks use
+static const size_t MAX_OBJECTS  = 1024;
+static const size_t MAX_CONTEXTS = 1024;
+
+// Handles point to real objects, so they look like real pointers; the second
+// half of the array is used for handles which are never added
+struct Object
+{
+    uint64_t data[4];
+};
+
+inline Object objects[2 * MAX_OBJECTS];
+
+/**
+ * Get the i-th handle which benchmarks add to their tables
+ */
+static inline HandleMgr_Handle_t
+handle(
+    size_t i)
+{
+    return &objects[i];
+}
+
+/**
+ * Get the i-th handle which is never added to any table
+ */
+static inline HandleMgr_Handle_t
+unknownHandle(
+    size_t i)
+{
+    return &objects[MAX_OBJECTS + i];
+}
+
+// Dummy client context, taken from a static pool so the benchmarks measure
+// the managers and not the allocator
+struct ClientCtx
+{
+    ContextMgr_CID_t cid;
+};
+
+inline ClientCtx clientPool[MAX_CONTEXTS];
+inline size_t clientPoolUsed = 0;
+
+static inline OS_Error_t
+initClient(
+    const ContextMgr_CID_t cid,
+    void**                 mem)
+{
+    ClientCtx* p = &clientPool[clientPoolUsed++ % MAX_CONTEXTS];
+
+    p->cid = cid;
+    *mem = p;
+
+    return OS_SUCCESS;
+}
+
+static inline OS_Error_t
+freeClient(
+    const ContextMgr_CID_t cid,
+    void*                  mem)
+{
+    (void) cid;
+    (void) mem;
+
+    return OS_SUCCESS;
+}
+
+/**
+ * Memory callbacks handing out contexts from the static pool; set
+ * clientPoolUsed to zero before setting up a new manager
+ */
+static const ContextMgr_MemoryFuncs_t clientFns =
+{
+    .init = initClient,
+    .free = freeClient
+};
+
+} // namespace bench
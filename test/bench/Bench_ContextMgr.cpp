@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "BenchUtil.h"
+
+extern "C"
+{
+#include "lib_server/ContextMgr.h"
+}
+
+// Private functions -----------------------------------------------------------
+
+// CIDs are either dense (0..n-1) or scattered over the whole range
+static std::vector<ContextMgr_CID_t>
+makeCids(
+    bench::Distribution dist,
+    size_t              n)
+{
+    std::vector<ContextMgr_CID_t> cids(n);
+    std::mt19937 rng(7);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        cids[i] = (bench::DIST_DENSE == dist) ?
+                  static_cast<ContextMgr_CID_t>(i) : rng();
+    }
+
+    return cids;
+}
+
+static void
+populate(
+    ContextMgr_t*                        mgr,
+    const std::vector<ContextMgr_CID_t>& cids)
+{
+    void* ctx;
+
+    bench::clientPoolUsed = 0;
+    ContextMgr_init(mgr, &bench::clientFns, cids.size());
+    for (auto cid : cids)
+    {
+        ContextMgr_get(mgr, cid, &ctx);
+    }
+}
+
+// Benchmarks ------------------------------------------------------------------
+
+// Lookup of clients which already have a context; arguments are the number of
+// clients and how lookups are distributed over them
+static void
+BM_ContextMgr_get_hit(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    const auto dist = static_cast<bench::Distribution>(state.range(1));
+    auto cids = makeCids(dist, n);
+    auto seq = bench::makeSequence(dist, n);
+    ContextMgr_t mgr;
+    size_t i = 0;
+    void* ctx;
+
+    populate(&mgr, cids);
+    for (auto _ : state)
+    {
+        ContextMgr_get(&mgr, cids[seq[i++ & (bench::SEQUENCE_LEN - 1)]], &ctx);
+        benchmark::DoNotOptimize(ctx);
+    }
+    ContextMgr_free(&mgr);
+
+    state.SetLabel(bench::distributionNames[dist]);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ContextMgr_get_hit)
+->ArgsProduct({ benchmark::CreateRange(1, 1024, 4), { 0, 1, 2 } });
+
+// Same as above, but lookups are spread over so many instances that the slots
+// are no longer in the cache; this shows the cost of scanning cold memory
+static void
+BM_ContextMgr_get_hit_cold(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    const auto dist = static_cast<bench::Distribution>(state.range(1));
+    // Roughly 16 MiB worth of slots (a slot is about 24 bytes)
+    const size_t numMgrs = std::max<size_t>(16, ((size_t) 1 << 24) / (n * 24));
+    auto cids = makeCids(dist, n);
+    auto seq = bench::makeSequence(dist, n);
+    std::vector<ContextMgr_t> mgrs(std::min<size_t>(numMgrs, 4096));
+    size_t i = 0, m = 0;
+    void* ctx;
+
+    for (auto& mgr : mgrs)
+    {
+        populate(&mgr, cids);
+    }
+    for (auto _ : state)
+    {
+        ContextMgr_get(&mgrs[m], cids[seq[i++ & (bench::SEQUENCE_LEN - 1)]],
+                       &ctx);
+        benchmark::DoNotOptimize(ctx);
+        m = (m + 1 == mgrs.size()) ? 0 : m + 1;
+    }
+    for (auto& mgr : mgrs)
+    {
+        ContextMgr_free(&mgr);
+    }
+
+    state.SetLabel(bench::distributionNames[dist]);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ContextMgr_get_hit_cold)
+->ArgsProduct({ benchmark::CreateRange(1, 1024, 4), { 0, 1, 2 } });
+
+// First lookup of a client, which has to search all slots before it assigns
+// a free one; argument is the number of clients
+static void
+BM_ContextMgr_get_miss(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    auto cids = makeCids(bench::DIST_RANDOM, n);
+    ContextMgr_t mgr;
+    void* ctx;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        bench::clientPoolUsed = 0;
+        ContextMgr_init(&mgr, &bench::clientFns, n);
+        state.ResumeTiming();
+
+        for (auto cid : cids)
+        {
+            ContextMgr_get(&mgr, cid, &ctx);
+            benchmark::DoNotOptimize(ctx);
+        }
+
+        state.PauseTiming();
+        ContextMgr_free(&mgr);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ContextMgr_get_miss)->RangeMultiplier(4)->Range(1, 1024);
+
+// Teardown of all clients; argument is the number of clients
+static void
+BM_ContextMgr_free(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    auto cids = makeCids(bench::DIST_RANDOM, n);
+    ContextMgr_t mgr;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        populate(&mgr, cids);
+        state.ResumeTiming();
+
+        ContextMgr_free(&mgr);
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ContextMgr_free)->RangeMultiplier(4)->Range(1, 1024);
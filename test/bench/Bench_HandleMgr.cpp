@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "BenchUtil.h"
+
+extern "C"
+{
+#include "lib_server/ConcurrentHandleMgr.h"
+#include "lib_server/HandleMgr.h"
+}
+
+#define MAX_HANDLES bench::MAX_OBJECTS
+
+// Everything needed to run a HandleMgr benchmark on n handles
+struct Fixture
+{
+    Fixture(
+        size_t           n,
+        bool             withFilter,
+        HandleMgr_Mode_t mode = HandleMgr_MODE_LINEAR)
+    {
+        std::vector<HandleMgr_Handle_t> handles(n);
+
+        HandleMgr_init(&mgr, buffer, sizeof(buffer), NULL);
+        HandleMgr_setMode(&mgr, mode);
+        if (withFilter)
+        {
+            HandleMgr_initFilter(&mgr, filter, sizeof(filter));
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            handles[i] = bench::handle(i);
+        }
+        if (n > 0)
+        {
+            HandleMgr_addBatch(&mgr, handles.data(), n);
+        }
+    }
+
+    ~Fixture()
+    {
+        HandleMgr_free(&mgr);
+    }
+
+    HandleMgr_t mgr;
+    HandleMgr_Handle_t buffer[MAX_HANDLES + 1];
+    uint32_t filter[HandleMgr_SIZE_OF_FILTER(MAX_HANDLES) / sizeof(uint32_t)];
+};
+
+// Sequence of handles to validate, with the given share of valid ones
+static std::vector<HandleMgr_Handle_t>
+makeHandles(
+    size_t n,
+    size_t validPercent)
+{
+    auto seq = bench::makeSequence(bench::DIST_RANDOM, n);
+    std::vector<HandleMgr_Handle_t> handles(seq.size());
+    std::mt19937 rng(11);
+
+    for (size_t i = 0; i < seq.size(); i++)
+    {
+        bool valid = (rng() % 100) < validPercent;
+        handles[i] = valid ? bench::handle(seq[i]) :
+                     bench::unknownHandle(seq[i]);
+    }
+
+    return handles;
+}
+
+// Benchmarks ------------------------------------------------------------------
+
+// Validation; arguments are the number of handles, the share of valid handles
+// in percent, whether the Bloom filter is used and the mode (linear/sorted)
+static void
+BM_HandleMgr_validate(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    Fixture f(n, state.range(2), static_cast<HandleMgr_Mode_t>(state.range(3)));
+    auto handles = makeHandles(n, state.range(1));
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            HandleMgr_validate(&f.mgr,
+                               handles[i++ & (bench::SEQUENCE_LEN - 1)]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleMgr_validate)
+->ArgNames({ "handles", "valid%", "filter", "sorted" })
+->ArgsProduct({ benchmark::CreateRange(1, 1024, 4), { 100, 50, 0 }, { 0, 1 },
+                { HandleMgr_MODE_LINEAR, HandleMgr_MODE_SORTED } });
+
+// Validation of valid handles where few of them get most of the lookups;
+// arguments are the number of handles, how lookups are distributed and the
+// mode (linear/transpose)
+static void
+BM_HandleMgr_validate_skewed(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    const auto dist = static_cast<bench::Distribution>(state.range(1));
+    Fixture f(n, false, static_cast<HandleMgr_Mode_t>(state.range(2)));
+    auto seq = bench::makeSequence(dist, n);
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        HandleMgr_Handle_t h =
+            bench::handle(seq[i++ & (bench::SEQUENCE_LEN - 1)]);
+        benchmark::DoNotOptimize(HandleMgr_validate(&f.mgr, h));
+    }
+
+    state.SetLabel(bench::distributionNames[dist]);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleMgr_validate_skewed)
+->ArgNames({ "handles", "dist", "mode" })
+->ArgsProduct({ benchmark::CreateRange(4, 256, 4),
+                { bench::DIST_RANDOM, bench::DIST_ZIPF },
+                { HandleMgr_MODE_LINEAR, HandleMgr_MODE_TRANSPOSE } });
+
+// Adding and removing one handle while n others are in the manager
+static void
+BM_HandleMgr_add_remove(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    Fixture f(n, state.range(1), static_cast<HandleMgr_Mode_t>(state.range(2)));
+    HandleMgr_Handle_t h = bench::unknownHandle(0);
+
+    for (auto _ : state)
+    {
+        HandleMgr_add(&f.mgr, h);
+        HandleMgr_remove(&f.mgr, h);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_HandleMgr_add_remove)
+->ArgNames({ "handles", "filter", "sorted" })
+->ArgsProduct({ benchmark::CreateRange(1, 1024, 4), { 0, 1 },
+                { HandleMgr_MODE_LINEAR, HandleMgr_MODE_SORTED } });
+
+// Teardown of a client, which removes all its handles in the order they were
+// added
+static void
+BM_HandleMgr_remove_all(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    Fixture f(0, false);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (size_t i = 0; i < n; i++)
+        {
+            HandleMgr_add(&f.mgr, bench::handle(i));
+        }
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < n; i++)
+        {
+            HandleMgr_remove(&f.mgr, bench::handle(i));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_HandleMgr_remove_all)->RangeMultiplier(4)->Range(1, 1024);
+
+// Validation with the ConcurrentHandleMgr, to compare against the HandleMgr;
+// arguments are the number of handles and the share of valid handles
+static void
+BM_ConcurrentHandleMgr_validate(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    static ConcurrentHandleMgr_Slot_t buffer[MAX_HANDLES];
+    ConcurrentHandleMgr_t mgr;
+    auto handles = makeHandles(n, state.range(1));
+    size_t i = 0;
+
+    ConcurrentHandleMgr_init(&mgr, buffer, sizeof(buffer), NULL, NULL, NULL);
+    for (size_t j = 0; j < n; j++)
+    {
+        ConcurrentHandleMgr_add(&mgr, bench::handle(j));
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            ConcurrentHandleMgr_validate(&mgr,
+                                         handles[i++ & (bench::SEQUENCE_LEN - 1)]));
+    }
+    ConcurrentHandleMgr_free(&mgr);
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConcurrentHandleMgr_validate)
+->ArgNames({ "handles", "valid%" })
+->ArgsProduct({ benchmark::CreateRange(1, 1024, 4), { 100, 50, 0 } });
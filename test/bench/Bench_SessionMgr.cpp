@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "BenchUtil.h"
+
+extern "C"
+{
+#include "lib_server/ContextMgr.h"
+#include "lib_server/HandleMgr.h"
+#include "lib_server/SessionMgr.h"
+}
+
+#include <cstdlib>
+
+// Client context as a server would have it with separate managers: the
+// HandleMgr of the client lives inside the context allocated by the ContextMgr
+typedef struct
+{
+    ContextMgr_CID_t cid;
+    HandleMgr_t handles;
+    void* buffer;
+} ClientCtx_t;
+
+#define MAX_CLIENTS 64
+#define MAX_HANDLES 16
+
+static std::vector<ClientCtx_t> pool(MAX_CLIENTS);
+static size_t poolUsed = 0;
+
+// Private functions -----------------------------------------------------------
+
+static OS_Error_t
+initClient(
+    const ContextMgr_CID_t cid,
+    void**                 mem)
+{
+    ClientCtx_t* p = &pool[poolUsed++ % MAX_CLIENTS];
+
+    p->cid    = cid;
+    p->buffer = malloc(HandleMgr_SIZE_OF_BUFFER(MAX_HANDLES));
+    HandleMgr_init(&p->handles, p->buffer,
+                   HandleMgr_SIZE_OF_BUFFER(MAX_HANDLES), NULL);
+    *mem = p;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+freeClient(
+    const ContextMgr_CID_t cid,
+    void*                  mem)
+{
+    ClientCtx_t* p = static_cast<ClientCtx_t*>(mem);
+
+    (void) cid;
+
+    HandleMgr_free(&p->handles);
+    free(p->buffer);
+
+    return OS_SUCCESS;
+}
+
+static const ContextMgr_MemoryFuncs_t fns =
+{
+    .init = initClient,
+    .free = freeClient
+};
+
+static inline HandleMgr_Handle_t
+handleOf(
+    size_t i)
+{
+    return reinterpret_cast<HandleMgr_Handle_t>((i + 1) * 64);
+}
+
+// Benchmarks ------------------------------------------------------------------
+
+// What servers do today: ContextMgr_get() followed by HandleMgr_validate() on
+// the manager inside the context; argument is the number of clients, each has
+// MAX_HANDLES handles
+static void
+BM_SessionMgr_separate(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    auto seq = bench::makeSequence(bench::DIST_RANDOM, n * MAX_HANDLES);
+    ContextMgr_t mgr;
+    ClientCtx_t* ctx;
+    size_t i = 0, k;
+
+    poolUsed = 0;
+    ContextMgr_init(&mgr, &fns, n);
+    for (size_t c = 0; c < n; c++)
+    {
+        ContextMgr_get(&mgr, c, (void**) &ctx);
+        for (size_t h = 0; h < MAX_HANDLES; h++)
+        {
+            HandleMgr_add(&ctx->handles, handleOf(h));
+        }
+    }
+    for (auto _ : state)
+    {
+        k = seq[i++ & (bench::SEQUENCE_LEN - 1)];
+        ContextMgr_get(&mgr, k / MAX_HANDLES, (void**) &ctx);
+        benchmark::DoNotOptimize(
+            HandleMgr_validate(&ctx->handles, handleOf(k % MAX_HANDLES)));
+    }
+    ContextMgr_free(&mgr);
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionMgr_separate)->RangeMultiplier(4)->Range(1, MAX_CLIENTS);
+
+// Same lookups, but resolved in a single call to SessionMgr_resolve()
+static void
+BM_SessionMgr_resolve(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    auto seq = bench::makeSequence(bench::DIST_RANDOM, n * MAX_HANDLES);
+    SessionMgr_t mgr;
+    void* ctx;
+    size_t i = 0, k;
+
+    poolUsed = 0;
+    SessionMgr_init(&mgr, &fns, n, MAX_HANDLES);
+    for (size_t c = 0; c < n; c++)
+    {
+        for (size_t h = 0; h < MAX_HANDLES; h++)
+        {
+            SessionMgr_addHandle(&mgr, c, handleOf(h));
+        }
+    }
+    for (auto _ : state)
+    {
+        k = seq[i++ & (bench::SEQUENCE_LEN - 1)];
+        benchmark::DoNotOptimize(
+            SessionMgr_resolve(&mgr, k / MAX_HANDLES, handleOf(k % MAX_HANDLES),
+                               &ctx));
+    }
+    SessionMgr_free(&mgr);
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionMgr_resolve)->RangeMultiplier(4)->Range(1, MAX_CLIENTS);
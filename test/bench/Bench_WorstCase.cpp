@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "BenchUtil.h"
+
+extern "C"
+{
+#include "lib_server/ContextMgr.h"
+#include "lib_server/HandleMgr.h"
+}
+
+// Real-time servers care about the slowest operation, not the average one, so
+// these benchmarks time every single operation in cycles and report p50,
+// p99.9 and max. A fixed number of iterations gives each run the same number
+// of samples to take the tail from.
+#define ITERATIONS  100000
+#define MAX_HANDLES bench::MAX_OBJECTS
+#define MAX_CLIENTS bench::MAX_CONTEXTS
+
+static const char* const modeNames[] = { "linear", "sorted", "bounded" };
+
+/**
+ * Collects the duration of single operations, so a benchmark can report the
+ * tail of the distribution and not just the average. Each sample includes the
+ * overhead of reading the counter twice.
+ */
+class Latencies
+{
+public:
+    void
+    add(
+        uint64_t cycles)
+    {
+        samples_.push_back(cycles);
+    }
+
+    /**
+     * Add median, 99.9th percentile and maximum as counters to the report
+     */
+    void
+    report(
+        benchmark::State& state)
+    {
+        if (samples_.empty())
+        {
+            return;
+        }
+
+        std::sort(samples_.begin(), samples_.end());
+        state.counters["p50"]   = at(0.5);
+        state.counters["p99.9"] = at(0.999);
+        state.counters["max"]   = static_cast<double>(samples_.back());
+    }
+
+private:
+    double
+    at(
+        double q) const
+    {
+        size_t i =
+            static_cast<size_t>(q * static_cast<double>(samples_.size()));
+
+        return static_cast<double>(samples_[std::min(i, samples_.size() - 1)]);
+    }
+
+    std::vector<uint64_t> samples_;
+};
+
+// Private functions -----------------------------------------------------------
+
+// Set up a handle manager with n handles; tables in bounded mode get twice the
+// room, as recommended for that mode. Returns false if a handle was rejected.
+static bool
+populate(
+    HandleMgr_t*                     mgr,
+    std::vector<HandleMgr_Handle_t>& buffer,
+    size_t                           n,
+    HandleMgr_Mode_t                 mode)
+{
+    std::vector<HandleMgr_Handle_t> handles(n);
+
+    buffer.resize((HandleMgr_MODE_BOUNDED == mode) ? 2 * n : n + 1);
+    if (HandleMgr_init(mgr, buffer.data(),
+                       buffer.size() * sizeof(HandleMgr_Handle_t),
+                       NULL) != OS_SUCCESS)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        handles[i] = bench::handle(i);
+    }
+
+    if (HandleMgr_setMode(mgr, mode) != OS_SUCCESS ||
+        HandleMgr_addBatch(mgr, handles.data(), n) != OS_SUCCESS)
+    {
+        HandleMgr_free(mgr);
+        return false;
+    }
+
+    return true;
+}
+
+// Benchmarks ------------------------------------------------------------------
+
+// Single validations on a table with n handles, where half of the lookups are
+// for unknown handles; arguments are the number of handles and the mode
+static void
+BM_WorstCase_HandleMgr_validate(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    const auto mode = static_cast<HandleMgr_Mode_t>(state.range(1));
+    auto seq = bench::makeSequence(bench::DIST_RANDOM, 2 * n);
+    std::vector<HandleMgr_Handle_t> buffer;
+    Latencies lat;
+    HandleMgr_t mgr;
+    size_t i = 0;
+
+    if (!populate(&mgr, buffer, n, mode))
+    {
+        state.SkipWithError("Could not add all handles");
+        return;
+    }
+    for (auto _ : state)
+    {
+        size_t j = seq[i++ & (bench::SEQUENCE_LEN - 1)];
+        bool known = j < n;
+        HandleMgr_Handle_t h = known ? bench::handle(j) :
+                               bench::unknownHandle(j - n);
+        uint64_t start = bench::readCycles();
+        HandleMgr_Handle_t found = HandleMgr_validate(&mgr, h);
+        lat.add(bench::readCycles() - start);
+        if ((found != NULL) != known)
+        {
+            state.SkipWithError("Wrong result of HandleMgr_validate()");
+            break;
+        }
+    }
+    HandleMgr_free(&mgr);
+
+    lat.report(state);
+    state.SetLabel(modeNames[mode]);
+}
+BENCHMARK(BM_WorstCase_HandleMgr_validate)
+->ArgsProduct({ { 16, 256, MAX_HANDLES }, { 0, 1, 2 } })
+->Iterations(ITERATIONS);
+
+// Single adds and removes of unknown handles on a table which already has
+// n - 1 handles; arguments are the number of handles and the mode
+static void
+BM_WorstCase_HandleMgr_add_remove(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    const auto mode = static_cast<HandleMgr_Mode_t>(state.range(1));
+    auto seq = bench::makeSequence(bench::DIST_RANDOM, n);
+    std::vector<HandleMgr_Handle_t> buffer;
+    Latencies lat;
+    HandleMgr_t mgr;
+    size_t i = 0;
+    OS_Error_t err;
+
+    if (!populate(&mgr, buffer, n - 1, mode))
+    {
+        state.SkipWithError("Could not add all handles");
+        return;
+    }
+    for (auto _ : state)
+    {
+        HandleMgr_Handle_t h =
+            bench::unknownHandle(seq[i++ & (bench::SEQUENCE_LEN - 1)]);
+        uint64_t start = bench::readCycles();
+        err = HandleMgr_add(&mgr, h);
+        lat.add(bench::readCycles() - start);
+        if (err != OS_SUCCESS)
+        {
+            state.SkipWithError("HandleMgr_add() failed");
+            break;
+        }
+
+        start = bench::readCycles();
+        err = HandleMgr_remove(&mgr, h);
+        lat.add(bench::readCycles() - start);
+        if (err != OS_SUCCESS)
+        {
+            state.SkipWithError("HandleMgr_remove() failed");
+            break;
+        }
+    }
+    HandleMgr_free(&mgr);
+
+    lat.report(state);
+    state.SetLabel(modeNames[mode]);
+}
+BENCHMARK(BM_WorstCase_HandleMgr_add_remove)
+->ArgsProduct({ { 16, 256, MAX_HANDLES }, { 0, 1, 2 } })
+->Iterations(ITERATIONS);
+
+// Single lookups of clients which already have a context, with CIDs scattered
+// over the whole range; arguments are the number of clients and whether the
+// manager was initialized with bounded lookup time
+static void
+BM_WorstCase_ContextMgr_get(
+    benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    const bool bounded = state.range(1);
+    auto seq = bench::makeSequence(bench::DIST_RANDOM, n);
+    std::vector<ContextMgr_CID_t> cids(n);
+    std::mt19937 rng(7);
+    Latencies lat;
+    ContextMgr_t mgr;
+    size_t i = 0;
+    OS_Error_t err;
+    void* ctx;
+
+    bench::clientPoolUsed = 0;
+    err = bounded ? ContextMgr_initBounded(&mgr, &bench::clientFns, n) :
+          ContextMgr_init(&mgr, &bench::clientFns, n);
+    if (err != OS_SUCCESS)
+    {
+        state.SkipWithError("Could not initialize ContextMgr");
+        return;
+    }
+    for (auto& cid : cids)
+    {
+        cid = rng();
+        if (ContextMgr_get(&mgr, cid, &ctx) != OS_SUCCESS)
+        {
+            state.SkipWithError("Could not add all clients");
+            ContextMgr_free(&mgr);
+            return;
+        }
+    }
+
+    for (auto _ : state)
+    {
+        ContextMgr_CID_t cid = cids[seq[i++ & (bench::SEQUENCE_LEN - 1)]];
+        uint64_t start = bench::readCycles();
+        err = ContextMgr_get(&mgr, cid, &ctx);
+        lat.add(bench::readCycles() - start);
+        if (err != OS_SUCCESS)
+        {
+            state.SkipWithError("ContextMgr_get() failed");
+            break;
+        }
+    }
+    ContextMgr_free(&mgr);
+
+    lat.report(state);
+    state.SetLabel(bounded ? "bounded" : "linear");
+}
+BENCHMARK(BM_WorstCase_ContextMgr_get)
+->ArgsProduct({ { 16, 256, MAX_CLIENTS }, { 0, 1 } })
+->Iterations(ITERATIONS);
@@ -0,0 +1,1299 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief Fuzz target comparing all lib_server backends with a reference model
+ *
+ * The input is read as a program of operations: add, remove, validate,
+ * batch add and batch remove of handles, acquire and release of handle
+ * references, get of client contexts and re-init of the managers. Every
+ * handle operation is run on all handle manager backends which support it,
+ * every context operation on all context manager backends, and each result is
+ * compared with a simple model based on std::set/std::map. After every
+ * operation, all handles of the (small) universe are validated on all handle
+ * backends, so a backend which loses or invents a handle is caught right away.
+ *
+ * References are held across operations, so the deferred removal of the
+ * ConcurrentHandleMgr is checked as well: a removed handle is released exactly
+ * when its last reference is dropped, and it can't be added again before.
+ *
+ * Backends may only deviate from the model where their documentation allows
+ * it: bounded tables may reject an entry before they are full, and a growable
+ * HandleMgr never runs out of space.
+ *
+ * Built with libFuzzer, LLVMFuzzerTestOneInput() is the entry point. Without
+ * it, main() runs all files given as inputs, or random inputs if there are
+ * none; a failed check prints the backend and aborts.
+ */
+
+extern "C"
+{
+#include "lib_server/ConcurrentHandleMgr.h"
+#include "lib_server/ContextMgr.h"
+#include "lib_server/HandleMgr.h"
+#include "lib_server/SessionMgr.h"
+#include "lib_server/SharedHandleMgr.h"
+}
+
+#include "lib_server/ContextTable.hpp"
+#include "lib_server/HandleSet.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+// Handles and CIDs are drawn from small sets, so duplicates and full managers
+// are common; handle value 0 is the NULL handle
+#define NUM_VALUES  40
+#define NUM_CIDS    24
+#define MAX_HANDLES 16
+#define MAX_CLIENTS 16
+#define MAX_BATCH   4
+
+// Number and max length of inputs if main() has to make them up
+#define RANDOM_RUNS 2000
+#define RANDOM_LEN  256
+
+#define FUZZ_CHECK(backend, cond)                                           \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            fprintf(stderr, "%s:%d: %s: check failed: %s\n", __FILE__,      \
+                    __LINE__, (backend)->name, #cond);                      \
+            abort();                                                        \
+        }                                                                   \
+    } while (0)
+
+enum Op
+{
+    OP_ADD = 0,
+    OP_REMOVE,
+    OP_VALIDATE,
+    OP_ADD_BATCH,
+    OP_INIT_HANDLES,
+    OP_GET,
+    OP_INIT_CONTEXTS,
+    OP_REMOVE_BATCH,
+    OP_ACQUIRE,
+    OP_RELEASE,
+    NUM_OPS
+};
+
+static HandleMgr_Handle_t
+toHandle(
+    const uint8_t x)
+{
+    // Aligned like real pointers
+    return (HandleMgr_Handle_t) (uintptr_t) ((x % NUM_VALUES) * 16);
+}
+
+static ContextMgr_CID_t
+toCid(
+    const uint8_t x)
+{
+    // Spread CIDs over the whole range, so all bits go into hashing
+    return (ContextMgr_CID_t) ((x % NUM_CIDS) * 0x01000193u);
+}
+
+// Most of the time, pick one of the given handles instead of a random one;
+// otherwise references to known handles would hardly ever pile up
+static HandleMgr_Handle_t
+pickHandle(
+    const std::vector<uintptr_t>& known,
+    const uint8_t                 x)
+{
+    return ((x & 0x80) && !known.empty()) ?
+           (HandleMgr_Handle_t) known[x % known.size()] : toHandle(x);
+}
+
+// Client contexts -------------------------------------------------------------
+
+// Contexts handed out by the callbacks are tracked, so a context which is
+// free'd twice, with the wrong CID or not at all is detected
+struct TrackedCtx
+{
+    explicit TrackedCtx(
+        ContextMgr_CID_t c)
+        : cid(c)
+    {
+    }
+
+    // Constructor used by the ContextTable
+    TrackedCtx(
+        lib_server::WithCid,
+        ContextMgr_CID_t c)
+        : cid(c)
+    {
+    }
+
+    ContextMgr_CID_t cid;
+};
+
+static std::set<void*> liveCtxs;
+static bool failInit = false;
+
+static OS_Error_t
+initTracked(
+    const ContextMgr_CID_t cid,
+    void**                 mem)
+{
+    TrackedCtx* p;
+
+    if (failInit)
+    {
+        return OS_ERROR_ABORTED;
+    }
+
+    p = new TrackedCtx(cid);
+    liveCtxs.insert(p);
+    *mem = p;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+freeTracked(
+    const ContextMgr_CID_t cid,
+    void*                  mem)
+{
+    TrackedCtx* p = static_cast<TrackedCtx*>(mem);
+
+    if (liveCtxs.erase(mem) != 1 || p->cid != cid)
+    {
+        fprintf(stderr, "Context of CID=%u free'd twice or with wrong CID\n",
+                cid);
+        abort();
+    }
+    delete p;
+
+    return OS_SUCCESS;
+}
+
+static const ContextMgr_MemoryFuncs_t trackedFns =
+{
+    .init = initTracked,
+    .free = freeTracked
+};
+
+// The SessionMgr handle backend needs a context as well, which is not subject
+// to the failures injected for the context backends
+static uint8_t sessionCtx;
+
+static OS_Error_t
+initSession(
+    const ContextMgr_CID_t cid,
+    void**                 mem)
+{
+    (void) cid;
+    *mem = &sessionCtx;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+freeSession(
+    const ContextMgr_CID_t cid,
+    void*                  mem)
+{
+    (void) cid;
+    (void) mem;
+
+    return OS_SUCCESS;
+}
+
+static const ContextMgr_MemoryFuncs_t sessionFns =
+{
+    .init = initSession,
+    .free = freeSession
+};
+
+// Handle backends -------------------------------------------------------------
+
+struct HandleBackend
+{
+    HandleBackend(
+        const char* n,
+        bool        g = false,
+        bool        r = false)
+        : name(n), growable(g), rejectsEarly(r)
+    {
+    }
+
+    virtual ~HandleBackend() = default;
+
+    virtual void
+    init(
+        size_t capacity) = 0;
+
+    virtual void
+    free() = 0;
+
+    virtual OS_Error_t
+    add(
+        HandleMgr_Handle_t h) = 0;
+
+    virtual bool
+    hasBatch() const
+    {
+        return false;
+    }
+
+    virtual OS_Error_t
+    addBatch(
+        HandleMgr_Handle_t* handles,
+        size_t              n)
+    {
+        (void) handles;
+        (void) n;
+
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    virtual OS_Error_t
+    removeBatch(
+        HandleMgr_Handle_t* handles,
+        size_t              n)
+    {
+        (void) handles;
+        (void) n;
+
+        return OS_ERROR_NOT_SUPPORTED;
+    }
+
+    virtual OS_Error_t
+    remove(
+        HandleMgr_Handle_t h) = 0;
+
+    virtual HandleMgr_Handle_t
+    validate(
+        HandleMgr_Handle_t h) = 0;
+
+    // Handles which were removed, but still take up room as they are in use
+    virtual bool
+    isPending(
+        uintptr_t x) const
+    {
+        (void) x;
+
+        return false;
+    }
+
+    virtual size_t
+    numPending() const
+    {
+        return 0;
+    }
+
+    // Additional checks of a backend's state against the model
+    virtual void
+    verify()
+    {
+    }
+
+    const char* name;
+    bool growable;
+    bool rejectsEarly;
+    size_t capacity = 0;
+    std::set<uintptr_t> model;
+};
+
+struct HandleMgrBackend : HandleBackend
+{
+    HandleMgrBackend(
+        const char*      n,
+        HandleMgr_Mode_t m,
+        bool             f,
+        bool             g = false)
+        : HandleBackend(n, g, HandleMgr_MODE_BOUNDED == m),
+          mode(m), withFilter(f)
+    {
+    }
+
+    void
+    init(
+        size_t capacity) override
+    {
+        HandleMgr_MemoryFuncs_t memFns = { .alloc = malloc, .free = ::free };
+
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   (growable ?
+                    HandleMgr_initGrowable(&mgr, &memFns, capacity) :
+                    HandleMgr_init(&mgr, buffer,
+                                   HandleMgr_SIZE_OF_BUFFER(capacity), NULL)));
+        FUZZ_CHECK(this, OS_SUCCESS == HandleMgr_setMode(&mgr, mode));
+        if (withFilter)
+        {
+            FUZZ_CHECK(this, OS_SUCCESS ==
+                       HandleMgr_initFilter(&mgr, filter, sizeof(filter)));
+        }
+    }
+
+    void
+    free() override
+    {
+        FUZZ_CHECK(this, OS_SUCCESS == HandleMgr_free(&mgr));
+    }
+
+    OS_Error_t
+    add(
+        HandleMgr_Handle_t h) override
+    {
+        return HandleMgr_add(&mgr, h);
+    }
+
+    bool
+    hasBatch() const override
+    {
+        return true;
+    }
+
+    OS_Error_t
+    addBatch(
+        HandleMgr_Handle_t* handles,
+        size_t              n) override
+    {
+        return HandleMgr_addBatch(&mgr, handles, n);
+    }
+
+    OS_Error_t
+    removeBatch(
+        HandleMgr_Handle_t* handles,
+        size_t              n) override
+    {
+        return HandleMgr_removeBatch(&mgr, handles, n);
+    }
+
+    OS_Error_t
+    remove(
+        HandleMgr_Handle_t h) override
+    {
+        return HandleMgr_remove(&mgr, h);
+    }
+
+    HandleMgr_Handle_t
+    validate(
+        HandleMgr_Handle_t h) override
+    {
+        return HandleMgr_validate(&mgr, h);
+    }
+
+    HandleMgr_Mode_t mode;
+    bool withFilter;
+    HandleMgr_t mgr;
+    HandleMgr_Handle_t buffer[MAX_HANDLES];
+    uint32_t filter[HandleMgr_SIZE_OF_FILTER(MAX_HANDLES) / sizeof(uint32_t)];
+};
+
+// Handles released by the ConcurrentHandleMgr, in order
+static std::vector<uintptr_t> released;
+
+static void
+releaseHandle(
+    HandleMgr_Handle_t h)
+{
+    released.push_back((uintptr_t) h);
+}
+
+struct ConcurrentBackend : HandleBackend
+{
+    ConcurrentBackend()
+        : HandleBackend("ConcurrentHandleMgr")
+    {
+    }
+
+    void
+    init(
+        size_t capacity) override
+    {
+        refs.clear();
+        pending.clear();
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   ConcurrentHandleMgr_init(
+                       &mgr, slots,
+                       ConcurrentHandleMgr_SIZE_OF_BUFFER(capacity),
+                       NULL, NULL, releaseHandle));
+    }
+
+    void
+    free() override
+    {
+        FUZZ_CHECK(this, OS_SUCCESS == ConcurrentHandleMgr_free(&mgr));
+    }
+
+    OS_Error_t
+    add(
+        HandleMgr_Handle_t h) override
+    {
+        return ConcurrentHandleMgr_add(&mgr, h);
+    }
+
+    OS_Error_t
+    remove(
+        HandleMgr_Handle_t h) override
+    {
+        uintptr_t x = (uintptr_t) h;
+        OS_Error_t err;
+
+        // Without references the handle is released right away, otherwise
+        // only once the last one is dropped
+        released.clear();
+        err = ConcurrentHandleMgr_remove(&mgr, h);
+        if (OS_SUCCESS == err && refs[x] > 0)
+        {
+            FUZZ_CHECK(this, released.empty());
+            pending.insert(x);
+        }
+        else if (OS_SUCCESS == err)
+        {
+            FUZZ_CHECK(this, released == std::vector<uintptr_t>(1, x));
+        }
+        else
+        {
+            FUZZ_CHECK(this, released.empty());
+        }
+
+        return err;
+    }
+
+    HandleMgr_Handle_t
+    validate(
+        HandleMgr_Handle_t h) override
+    {
+        HandleMgr_Handle_t ret = ConcurrentHandleMgr_validate(&mgr, h);
+
+        // A reference must be available for exactly the valid handles
+        FUZZ_CHECK(this, ConcurrentHandleMgr_acquire(&mgr, h) == ret);
+        if (NULL != ret)
+        {
+            FUZZ_CHECK(this, OS_SUCCESS ==
+                       ConcurrentHandleMgr_release(&mgr, h));
+        }
+
+        return ret;
+    }
+
+    bool
+    isPending(
+        uintptr_t x) const override
+    {
+        return pending.count(x) > 0;
+    }
+
+    size_t
+    numPending() const override
+    {
+        return pending.size();
+    }
+
+    // Handles the fuzzer holds references to, removed or not
+    std::vector<uintptr_t>
+    held() const
+    {
+        std::vector<uintptr_t> v;
+
+        for (auto& r : refs)
+        {
+            if (r.second > 0)
+            {
+                v.push_back(r.first);
+            }
+        }
+
+        return v;
+    }
+
+    ConcurrentHandleMgr_t mgr;
+    ConcurrentHandleMgr_Slot_t slots[MAX_HANDLES];
+    // References held by the fuzzer, and removed handles waiting for them
+    std::map<uintptr_t, size_t> refs;
+    std::set<uintptr_t> pending;
+};
+
+struct SharedBackend : HandleBackend
+{
+    SharedBackend()
+        : HandleBackend("SharedHandleMgr")
+    {
+    }
+
+    void
+    init(
+        size_t capacity) override
+    {
+        size_t size = SharedHandleMgr_SIZE_OF_REGION(capacity);
+
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   SharedHandleMgr_init(&writer, region, size, NULL));
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   SharedHandleMgr_attach(&reader, region, size, NULL));
+    }
+
+    void
+    free() override
+    {
+        FUZZ_CHECK(this, OS_SUCCESS == SharedHandleMgr_free(&reader));
+        FUZZ_CHECK(this, OS_SUCCESS == SharedHandleMgr_free(&writer));
+    }
+
+    OS_Error_t
+    add(
+        HandleMgr_Handle_t h) override
+    {
+        // Readers must never be able to change the region
+        FUZZ_CHECK(this, (NULL == h ? OS_ERROR_INVALID_PARAMETER :
+                          OS_ERROR_INVALID_STATE) ==
+                   SharedHandleMgr_add(&reader, h));
+
+        return SharedHandleMgr_add(&writer, h);
+    }
+
+    OS_Error_t
+    remove(
+        HandleMgr_Handle_t h) override
+    {
+        return SharedHandleMgr_remove(&writer, h);
+    }
+
+    HandleMgr_Handle_t
+    validate(
+        HandleMgr_Handle_t h) override
+    {
+        HandleMgr_Handle_t ret = SharedHandleMgr_validate(&writer, h);
+
+        FUZZ_CHECK(this, SharedHandleMgr_validate(&reader, h) == ret);
+
+        return ret;
+    }
+
+    SharedHandleMgr_t writer;
+    SharedHandleMgr_t reader;
+    uint64_t region[SharedHandleMgr_SIZE_OF_REGION(MAX_HANDLES) /
+                    sizeof(uint64_t)];
+};
+
+// The handles of a single client; the capacity is enforced with the quota
+struct SessionBackend : HandleBackend
+{
+    SessionBackend()
+        : HandleBackend("SessionMgr")
+    {
+    }
+
+    void
+    init(
+        size_t capacity) override
+    {
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   SessionMgr_init(&mgr, &sessionFns, 1, MAX_HANDLES));
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   SessionMgr_setQuota(&mgr, CID, capacity));
+    }
+
+    void
+    free() override
+    {
+        FUZZ_CHECK(this, OS_SUCCESS == SessionMgr_free(&mgr));
+    }
+
+    OS_Error_t
+    add(
+        HandleMgr_Handle_t h) override
+    {
+        return SessionMgr_addHandle(&mgr, CID, h);
+    }
+
+    OS_Error_t
+    remove(
+        HandleMgr_Handle_t h) override
+    {
+        return SessionMgr_removeHandle(&mgr, CID, h);
+    }
+
+    HandleMgr_Handle_t
+    validate(
+        HandleMgr_Handle_t h) override
+    {
+        void* ctx = NULL;
+
+        if (NULL == h || SessionMgr_resolve(&mgr, CID, h, &ctx) != OS_SUCCESS)
+        {
+            return NULL;
+        }
+        FUZZ_CHECK(this, &sessionCtx == ctx);
+
+        return h;
+    }
+
+    void
+    verify() override
+    {
+        size_t count;
+
+        FUZZ_CHECK(this, OS_SUCCESS == SessionMgr_getCount(&mgr, CID, &count));
+        FUZZ_CHECK(this, model.size() == count);
+    }
+
+    static const ContextMgr_CID_t CID = 7;
+    SessionMgr_t mgr;
+};
+
+// Handles of the HandleSet are typed, the type itself does not matter
+struct FuzzObject;
+
+// The capacity of the HandleSet is fixed at compile time
+struct HandleSetBackend : HandleBackend
+{
+    HandleSetBackend()
+        : HandleBackend("HandleSet")
+    {
+    }
+
+    void
+    init(
+        size_t c) override
+    {
+        (void) c;
+        capacity = MAX_HANDLES;
+        set = std::make_unique<lib_server::HandleSet<FuzzObject,
+                                                     MAX_HANDLES>>();
+    }
+
+    void
+    free() override
+    {
+        set.reset();
+    }
+
+    OS_Error_t
+    add(
+        HandleMgr_Handle_t h) override
+    {
+        return set->add(static_cast<FuzzObject*>(h));
+    }
+
+    OS_Error_t
+    remove(
+        HandleMgr_Handle_t h) override
+    {
+        return set->remove(static_cast<FuzzObject*>(h));
+    }
+
+    HandleMgr_Handle_t
+    validate(
+        HandleMgr_Handle_t h) override
+    {
+        return set->validate(static_cast<FuzzObject*>(h));
+    }
+
+    void
+    verify() override
+    {
+        FUZZ_CHECK(this, model.size() == set->size());
+    }
+
+    std::unique_ptr<lib_server::HandleSet<FuzzObject, MAX_HANDLES>> set;
+};
+
+// Context backends ------------------------------------------------------------
+
+struct ContextBackend
+{
+    ContextBackend(
+        const char* n,
+        bool        r = false,
+        bool        c = true)
+        : name(n), rejectsEarly(r), usesCallbacks(c)
+    {
+    }
+
+    virtual ~ContextBackend() = default;
+
+    virtual void
+    init(
+        size_t max) = 0;
+
+    virtual void
+    free() = 0;
+
+    virtual OS_Error_t
+    get(
+        ContextMgr_CID_t cid,
+        void**           ctx) = 0;
+
+    const char* name;
+    bool rejectsEarly;
+    bool usesCallbacks;
+    size_t max = 0;
+    std::map<ContextMgr_CID_t, void*> model;
+};
+
+struct ContextMgrBackend : ContextBackend
+{
+    ContextMgrBackend(
+        const char* n,
+        bool        b)
+        : ContextBackend(n, b), bounded(b)
+    {
+    }
+
+    void
+    init(
+        size_t m) override
+    {
+        max = m;
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   (bounded ? ContextMgr_initBounded(&mgr, &trackedFns, max) :
+                    ContextMgr_init(&mgr, &trackedFns, max)));
+    }
+
+    void
+    free() override
+    {
+        FUZZ_CHECK(this, OS_SUCCESS == ContextMgr_free(&mgr));
+    }
+
+    OS_Error_t
+    get(
+        ContextMgr_CID_t cid,
+        void**           ctx) override
+    {
+        return ContextMgr_get(&mgr, cid, ctx);
+    }
+
+    bool bounded;
+    ContextMgr_t mgr;
+};
+
+struct SessionCtxBackend : ContextBackend
+{
+    SessionCtxBackend()
+        : ContextBackend("SessionMgr_get")
+    {
+    }
+
+    void
+    init(
+        size_t m) override
+    {
+        max = m;
+        FUZZ_CHECK(this, OS_SUCCESS ==
+                   SessionMgr_init(&mgr, &trackedFns, max, 1));
+    }
+
+    void
+    free() override
+    {
+        FUZZ_CHECK(this, OS_SUCCESS == SessionMgr_free(&mgr));
+    }
+
+    OS_Error_t
+    get(
+        ContextMgr_CID_t cid,
+        void**           ctx) override
+    {
+        return SessionMgr_get(&mgr, cid, ctx);
+    }
+
+    SessionMgr_t mgr;
+};
+
+// The ContextTable constructs its contexts itself, so they are not tracked and
+// can't fail; its capacity is fixed at compile time
+struct ContextTableBackend : ContextBackend
+{
+    ContextTableBackend()
+        : ContextBackend("ContextTable", false, false)
+    {
+    }
+
+    void
+    init(
+        size_t m) override
+    {
+        (void) m;
+        max = MAX_CLIENTS;
+        table = std::make_unique<lib_server::ContextTable<TrackedCtx,
+                                                          MAX_CLIENTS>>();
+    }
+
+    void
+    free() override
+    {
+        table.reset();
+    }
+
+    OS_Error_t
+    get(
+        ContextMgr_CID_t cid,
+        void**           ctx) override
+    {
+        *ctx = table->get(cid);
+
+        return (NULL == *ctx) ? OS_ERROR_INSUFFICIENT_SPACE : OS_SUCCESS;
+    }
+
+    std::unique_ptr<lib_server::ContextTable<TrackedCtx, MAX_CLIENTS>> table;
+};
+
+// Checks ----------------------------------------------------------------------
+
+// Result of an operation is as expected, or the backend rejected an entry
+// because its bounded table was full
+static bool
+matches(
+    OS_Error_t got,
+    OS_Error_t expected,
+    bool       rejectsEarly)
+{
+    return got == expected ||
+           (rejectsEarly && OS_SUCCESS == expected &&
+            OS_ERROR_INSUFFICIENT_SPACE == got);
+}
+
+static void
+checkAdd(
+    HandleBackend*     b,
+    HandleMgr_Handle_t h)
+{
+    uintptr_t x = (uintptr_t) h;
+    OS_Error_t expected, got;
+
+    // A removed handle which is still in use counts as a duplicate
+    expected = (0 == x) ? OS_ERROR_INVALID_PARAMETER :
+               (b->model.count(x) > 0 || b->isPending(x)) ?
+               OS_ERROR_OPERATION_DENIED :
+               (!b->growable &&
+                b->model.size() + b->numPending() >= b->capacity) ?
+               OS_ERROR_INSUFFICIENT_SPACE : OS_SUCCESS;
+
+    got = b->add(h);
+    FUZZ_CHECK(b, matches(got, expected, b->rejectsEarly));
+    if (OS_SUCCESS == got)
+    {
+        b->model.insert(x);
+    }
+}
+
+static void
+checkAddBatch(
+    HandleBackend*                         b,
+    const std::vector<HandleMgr_Handle_t>& handles)
+{
+    // The batch is reordered, so every backend gets its own copy
+    std::vector<HandleMgr_Handle_t> batch(handles);
+    std::set<uintptr_t> unique;
+    OS_Error_t expected = OS_SUCCESS, got;
+
+    for (auto h : handles)
+    {
+        if (NULL == h)
+        {
+            expected = OS_ERROR_INVALID_PARAMETER;
+            break;
+        }
+        if (!unique.insert((uintptr_t) h).second ||
+            b->model.count((uintptr_t) h) > 0)
+        {
+            expected = OS_ERROR_OPERATION_DENIED;
+        }
+    }
+    if (OS_SUCCESS == expected && !b->growable &&
+        b->model.size() + handles.size() > b->capacity)
+    {
+        expected = OS_ERROR_INSUFFICIENT_SPACE;
+    }
+
+    got = b->addBatch(batch.data(), batch.size());
+    FUZZ_CHECK(b, matches(got, expected, b->rejectsEarly));
+    if (OS_SUCCESS == got)
+    {
+        b->model.insert(unique.begin(), unique.end());
+    }
+}
+
+static void
+checkRemoveBatch(
+    HandleBackend*                         b,
+    const std::vector<HandleMgr_Handle_t>& handles)
+{
+    std::vector<HandleMgr_Handle_t> batch(handles);
+    std::set<uintptr_t> unique;
+    OS_Error_t expected = OS_SUCCESS, got;
+
+    for (auto h : handles)
+    {
+        if (NULL == h)
+        {
+            expected = OS_ERROR_INVALID_PARAMETER;
+            break;
+        }
+        if (!unique.insert((uintptr_t) h).second ||
+            b->model.count((uintptr_t) h) == 0)
+        {
+            expected = OS_ERROR_INVALID_HANDLE;
+        }
+    }
+
+    got = b->removeBatch(batch.data(), batch.size());
+    FUZZ_CHECK(b, got == expected);
+    if (OS_SUCCESS == got)
+    {
+        for (auto x : unique)
+        {
+            b->model.erase(x);
+        }
+    }
+}
+
+static void
+checkRemove(
+    HandleBackend*     b,
+    HandleMgr_Handle_t h)
+{
+    uintptr_t x = (uintptr_t) h;
+    OS_Error_t expected;
+
+    expected = (0 == x)                  ? OS_ERROR_INVALID_PARAMETER :
+               (b->model.count(x) == 0)  ? OS_ERROR_INVALID_HANDLE : OS_SUCCESS;
+
+    FUZZ_CHECK(b, b->remove(h) == expected);
+    b->model.erase(x);
+}
+
+static void
+checkValidate(
+    HandleBackend*     b,
+    HandleMgr_Handle_t h)
+{
+    uintptr_t x = (uintptr_t) h;
+
+    FUZZ_CHECK(b, b->validate(h) == ((x != 0 && b->model.count(x) > 0) ?
+                                     h : NULL));
+}
+
+static void
+checkAcquire(
+    ConcurrentBackend* b,
+    HandleMgr_Handle_t h)
+{
+    uintptr_t x = (uintptr_t) h;
+    HandleMgr_Handle_t ret = ConcurrentHandleMgr_acquire(&b->mgr, h);
+
+    // Removed handles can't be acquired, even if they are still in use
+    FUZZ_CHECK(b, ret == ((x != 0 && b->model.count(x) > 0) ? h : NULL));
+    if (NULL != ret)
+    {
+        b->refs[x]++;
+    }
+}
+
+static void
+checkRelease(
+    ConcurrentBackend* b,
+    HandleMgr_Handle_t h)
+{
+    uintptr_t x = (uintptr_t) h;
+    size_t refs = (b->refs.count(x) > 0) ? b->refs[x] : 0;
+    OS_Error_t expected;
+
+    expected = (0 == x) ? OS_ERROR_INVALID_PARAMETER :
+               (refs > 0) ? OS_SUCCESS :
+               (b->model.count(x) > 0) ? OS_ERROR_INVALID_STATE :
+               OS_ERROR_INVALID_HANDLE;
+
+    released.clear();
+    FUZZ_CHECK(b, ConcurrentHandleMgr_release(&b->mgr, h) == expected);
+    if (OS_SUCCESS == expected && 0 == --b->refs[x] && b->isPending(x))
+    {
+        // The last reference to a removed handle releases it
+        FUZZ_CHECK(b, released == std::vector<uintptr_t>(1, x));
+        b->pending.erase(x);
+    }
+    else
+    {
+        FUZZ_CHECK(b, released.empty());
+    }
+}
+
+static void
+checkGet(
+    ContextBackend*  b,
+    ContextMgr_CID_t cid)
+{
+    auto it = b->model.find(cid);
+    void* ctx = NULL;
+    OS_Error_t got = b->get(cid, &ctx);
+
+    if (it != b->model.end())
+    {
+        FUZZ_CHECK(b, OS_SUCCESS == got && it->second == ctx);
+    }
+    else if (b->model.size() >= b->max)
+    {
+        FUZZ_CHECK(b, OS_ERROR_INSUFFICIENT_SPACE == got);
+    }
+    else if (failInit && b->usesCallbacks)
+    {
+        FUZZ_CHECK(b, OS_ERROR_ABORTED == got ||
+                   (b->rejectsEarly && OS_ERROR_INSUFFICIENT_SPACE == got));
+    }
+    else
+    {
+        FUZZ_CHECK(b, matches(got, OS_SUCCESS, b->rejectsEarly));
+        if (OS_SUCCESS == got)
+        {
+            FUZZ_CHECK(b, !b->usesCallbacks || liveCtxs.count(ctx) > 0);
+            FUZZ_CHECK(b, static_cast<TrackedCtx*>(ctx)->cid == cid);
+            b->model[cid] = ctx;
+        }
+    }
+}
+
+// Fuzzer ----------------------------------------------------------------------
+
+static void
+run(
+    const uint8_t* data,
+    size_t         size)
+{
+    std::vector<std::unique_ptr<HandleBackend>> handleBackends;
+    std::vector<std::unique_ptr<ContextBackend>> ctxBackends;
+    std::vector<HandleMgr_Handle_t> batch;
+    ConcurrentBackend* conc;
+    HandleMgr_Handle_t h;
+    size_t capacity, max, i;
+
+    if (size < 2)
+    {
+        return;
+    }
+    capacity = 1 + data[0] % MAX_HANDLES;
+    max      = 1 + data[1] % MAX_CLIENTS;
+
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(linear)",
+                                    HandleMgr_MODE_LINEAR, false));
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(linear,filter)",
+                                    HandleMgr_MODE_LINEAR, true));
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(sorted)",
+                                    HandleMgr_MODE_SORTED, false));
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(sorted,filter)",
+                                    HandleMgr_MODE_SORTED, true));
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(bounded)",
+                                    HandleMgr_MODE_BOUNDED, false));
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(transpose,filter)",
+                                    HandleMgr_MODE_TRANSPOSE, true));
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(growable)",
+                                    HandleMgr_MODE_LINEAR, false, true));
+    handleBackends.emplace_back(new HandleMgrBackend(
+                                    "HandleMgr(growable,sorted)",
+                                    HandleMgr_MODE_SORTED, false, true));
+    handleBackends.emplace_back(conc = new ConcurrentBackend());
+    handleBackends.emplace_back(new SharedBackend());
+    handleBackends.emplace_back(new SessionBackend());
+    handleBackends.emplace_back(new HandleSetBackend());
+
+    ctxBackends.emplace_back(new ContextMgrBackend("ContextMgr", false));
+    ctxBackends.emplace_back(new ContextMgrBackend("ContextMgr(bounded)",
+                                                   true));
+    ctxBackends.emplace_back(new SessionCtxBackend());
+    ctxBackends.emplace_back(new ContextTableBackend());
+
+    for (auto& b : handleBackends)
+    {
+        b->capacity = capacity;
+        b->init(capacity);
+    }
+    for (auto& b : ctxBackends)
+    {
+        b->init(max);
+    }
+
+    for (i = 2; i + 1 < size; i += 2)
+    {
+        uint8_t op  = data[i] % NUM_OPS;
+        uint8_t arg = data[i + 1];
+
+        switch (op)
+        {
+        case OP_ADD:
+            for (auto& b : handleBackends)
+            {
+                checkAdd(b.get(), toHandle(arg));
+            }
+            break;
+        case OP_REMOVE:
+            // Removing handles which are in use defers their release
+            h = pickHandle(conc->held(), arg);
+            for (auto& b : handleBackends)
+            {
+                checkRemove(b.get(), h);
+            }
+            break;
+        case OP_VALIDATE:
+            for (auto& b : handleBackends)
+            {
+                checkValidate(b.get(), toHandle(arg));
+            }
+            break;
+        case OP_ADD_BATCH:
+        case OP_REMOVE_BATCH:
+            // The handles of the batch follow the operation
+            batch.clear();
+            for (size_t n = 1 + arg % MAX_BATCH; n > 0 && i + 2 < size; n--)
+            {
+                batch.push_back(toHandle(data[i + 2]));
+                i++;
+            }
+            for (auto& b : handleBackends)
+            {
+                if (!b->hasBatch() || batch.empty())
+                {
+                    continue;
+                }
+                if (OP_ADD_BATCH == op)
+                {
+                    checkAddBatch(b.get(), batch);
+                }
+                else
+                {
+                    checkRemoveBatch(b.get(), batch);
+                }
+            }
+            break;
+        case OP_INIT_HANDLES:
+            for (auto& b : handleBackends)
+            {
+                b->free();
+                b->model.clear();
+                b->capacity = capacity;
+                b->init(capacity);
+            }
+            break;
+        case OP_GET:
+            // Let the init() callback fail every now and then
+            failInit = (arg >= 0xf0);
+            for (auto& b : ctxBackends)
+            {
+                checkGet(b.get(), toCid(arg));
+            }
+            failInit = false;
+            break;
+        case OP_INIT_CONTEXTS:
+            for (auto& b : ctxBackends)
+            {
+                b->free();
+                b->model.clear();
+            }
+            FUZZ_CHECK(ctxBackends[0], liveCtxs.empty());
+            for (auto& b : ctxBackends)
+            {
+                b->init(max);
+            }
+            break;
+        case OP_ACQUIRE:
+            checkAcquire(conc, pickHandle(std::vector<uintptr_t>(
+                                              conc->model.begin(),
+                                              conc->model.end()), arg));
+            break;
+        case OP_RELEASE:
+            checkRelease(conc, pickHandle(conc->held(), arg));
+            break;
+        }
+
+        // Exactly the handles of the model must be known
+        for (auto& b : handleBackends)
+        {
+            for (uint8_t v = 0; v < NUM_VALUES; v++)
+            {
+                checkValidate(b.get(), toHandle(v));
+            }
+            b->verify();
+        }
+    }
+
+    for (auto& b : handleBackends)
+    {
+        b->free();
+    }
+    for (auto& b : ctxBackends)
+    {
+        b->free();
+    }
+    FUZZ_CHECK(ctxBackends[0], liveCtxs.empty());
+}
+
+extern "C" int
+LLVMFuzzerTestOneInput(
+    const uint8_t* data,
+    size_t         size)
+{
+    run(data, size);
+
+    return 0;
+}
+
+#if !defined(LIB_SERVER_FUZZ_LIBFUZZER)
+
+int
+main(
+    int   argc,
+    char* argv[])
+{
+    std::vector<uint8_t> input;
+
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::ifstream f(argv[i], std::ios::binary);
+            if (!f)
+            {
+                fprintf(stderr, "Could not open %s\n", argv[i]);
+                return 1;
+            }
+            input.assign(std::istreambuf_iterator<char>(f),
+                         std::istreambuf_iterator<char>());
+            run(input.data(), input.size());
+        }
+        printf("%d inputs passed\n", argc - 1);
+
+        return 0;
+    }
+
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < RANDOM_RUNS; i++)
+    {
+        input.resize(rng() % RANDOM_LEN);
+        for (auto& x : input)
+        {
+            x = static_cast<uint8_t>(rng());
+        }
+        run(input.data(), input.size());
+    }
+    printf("%d random inputs passed\n", RANDOM_RUNS);
+
+    return 0;
+}
+
+#endif
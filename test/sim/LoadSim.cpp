@@ -0,0 +1,569 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+/**
+ * @file
+ * @brief Load simulator for RPC server components using lib_server
+ *
+ * Worker threads issue synthetic requests, just like the RPC handlers of a
+ * server component would: every request resolves a client context via
+ * ContextMgr_get() and validates an object handle via the client's handle
+ * manager. Object churn, client disconnects and bogus handles are mixed in at
+ * configurable rates. At the end, throughput and latency percentiles of the
+ * requests are reported.
+ *
+ * Handle managers are used in one of two modes:
+ * - "locked": a HandleMgr_t per client, guarded by a mutex which is held for
+ *   the whole request (as servers have to do without further support)
+ * - "lockfree": a ConcurrentHandleMgr_t per client, where requests acquire()
+ *   and release() the handle and only churn takes the writers lock
+ *
+ * All clients are connected before the workers start, so ContextMgr_get()
+ * only ever sees hits, which do not modify the ContextMgr. As there is no way
+ * to free a single client context, a disconnect is simulated by removing and
+ * re-adding all objects of a client; the client context itself stays.
+ *
+ * Hence there is no connect rate: requests never miss in the ContextMgr and
+ * never allocate a context, so connect-heavy load (short-lived clients, many
+ * calls of the init() callback) is not simulated. This needs a way to free a
+ * single context in the ContextMgr first.
+ */
+
+extern "C"
+{
+#include "lib_server/ConcurrentHandleMgr.h"
+#include "lib_server/ContextMgr.h"
+#include "lib_server/HandleMgr.h"
+}
+
+#include "../bench/BenchUtil.h"
+
+#include <getopt.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define MAX_HANDLES_PER_CLIENT 1024
+
+// Configuration ---------------------------------------------------------------
+
+struct Config
+{
+    size_t threads      = 4;
+    size_t clients      = 64;
+    size_t handles      = 16;
+    double duration     = 5.0;
+    double churn        = 0.01;     // share of requests replacing an object
+    double disconnect   = 0.0001;   // share of requests disconnecting
+    double invalid      = 0.01;     // share of requests with a bogus handle
+    size_t workNs       = 0;        // time spent per request, holding the handle
+    bool lockFree       = false;
+    bench::Distribution dist = bench::DIST_ZIPF;
+};
+
+static void
+usage(
+    const char* name)
+{
+    printf("Usage: %s [options]\n"
+           "  --threads N       worker threads (default 4)\n"
+           "  --clients N       number of clients, 1-1024 (default 64)\n"
+           "  --handles N       objects per client, 1-%d (default 16)\n"
+           "  --duration S      seconds to run (default 5)\n"
+           "  --churn P         share of requests replacing an object (0.01)\n"
+           "  --disconnect P    share of requests disconnecting (0.0001);\n"
+           "                    only the client's objects are re-created, not\n"
+           "                    its context, so there is no connect rate\n"
+           "  --invalid P       share of requests with bogus handles (0.01)\n"
+           "  --work NS         time spent per request on the object (0)\n"
+           "  --dist D          client selection: dense|random|zipf (zipf)\n"
+           "  --mode M          handle managers: locked|lockfree (locked)\n",
+           name, MAX_HANDLES_PER_CLIENT);
+}
+
+static bool
+parseArgs(
+    int     argc,
+    char**  argv,
+    Config& cfg)
+{
+    static const struct option opts[] =
+    {
+        { "threads",    required_argument, NULL, 't' },
+        { "clients",    required_argument, NULL, 'c' },
+        { "handles",    required_argument, NULL, 'h' },
+        { "duration",   required_argument, NULL, 'd' },
+        { "churn",      required_argument, NULL, 'o' },
+        { "disconnect", required_argument, NULL, 'x' },
+        { "invalid",    required_argument, NULL, 'i' },
+        { "work",       required_argument, NULL, 'w' },
+        { "dist",       required_argument, NULL, 's' },
+        { "mode",       required_argument, NULL, 'm' },
+        { NULL,         0,                 NULL, 0   }
+    };
+    int c;
+
+    while ((c = getopt_long(argc, argv, "", opts, NULL)) != -1)
+    {
+        switch (c)
+        {
+        case 't':
+            cfg.threads = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            cfg.clients = strtoul(optarg, NULL, 0);
+            break;
+        case 'h':
+            cfg.handles = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            cfg.duration = strtod(optarg, NULL);
+            break;
+        case 'o':
+            cfg.churn = strtod(optarg, NULL);
+            break;
+        case 'x':
+            cfg.disconnect = strtod(optarg, NULL);
+            break;
+        case 'i':
+            cfg.invalid = strtod(optarg, NULL);
+            break;
+        case 'w':
+            cfg.workNs = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            if (!strcmp(optarg, "dense"))
+            {
+                cfg.dist = bench::DIST_DENSE;
+            }
+            else if (!strcmp(optarg, "random"))
+            {
+                cfg.dist = bench::DIST_RANDOM;
+            }
+            else if (!strcmp(optarg, "zipf"))
+            {
+                cfg.dist = bench::DIST_ZIPF;
+            }
+            else
+            {
+                return false;
+            }
+            break;
+        case 'm':
+            if (!strcmp(optarg, "locked"))
+            {
+                cfg.lockFree = false;
+            }
+            else if (!strcmp(optarg, "lockfree"))
+            {
+                cfg.lockFree = true;
+            }
+            else
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return cfg.threads > 0 && cfg.duration > 0 &&
+           cfg.clients >= 1 && cfg.clients <= 1024 &&
+           cfg.handles >= 1 && cfg.handles <= MAX_HANDLES_PER_CLIENT;
+}
+
+// Latency histogram -----------------------------------------------------------
+
+// Log-linear histogram: 16 linear sub-buckets per power of two, so every
+// percentile is accurate to ~6% without having to keep all samples
+class Histogram
+{
+public:
+    void
+    record(
+        uint64_t ns)
+    {
+        buckets_[index(ns)]++;
+        count_++;
+        max_ = std::max(max_, ns);
+    }
+
+    void
+    merge(
+        const Histogram& other)
+    {
+        for (size_t i = 0; i < NUM_BUCKETS; i++)
+        {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t
+    percentile(
+        double p) const
+    {
+        uint64_t target = static_cast<uint64_t>(p * count_);
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < NUM_BUCKETS; i++)
+        {
+            if ((seen += buckets_[i]) > target)
+            {
+                return value(i);
+            }
+        }
+
+        return max_;
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+
+private:
+    static const size_t SUB_BITS = 4;
+    static const size_t NUM_BUCKETS = 64 << SUB_BITS;
+
+    static size_t
+    index(
+        uint64_t v)
+    {
+        if (v < (1u << SUB_BITS))
+        {
+            return v;
+        }
+        size_t msb = 63 - __builtin_clzll(v);
+        size_t sub = (v >> (msb - SUB_BITS)) & ((1u << SUB_BITS) - 1);
+        return ((msb - SUB_BITS + 1) << SUB_BITS) + sub;
+    }
+
+    // Upper bound of the values in a bucket
+    static uint64_t
+    value(
+        size_t idx)
+    {
+        if (idx < (1u << SUB_BITS))
+        {
+            return idx;
+        }
+        size_t msb = (idx >> SUB_BITS) + SUB_BITS - 1;
+        uint64_t sub = idx & ((1u << SUB_BITS) - 1);
+        return ((((uint64_t) 1 << SUB_BITS) | sub) << (msb - SUB_BITS)) +
+               (((uint64_t) 1 << (msb - SUB_BITS)) - 1);
+    }
+
+    std::vector<uint64_t> buckets_ = std::vector<uint64_t>(NUM_BUCKETS);
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+// Simulated server ------------------------------------------------------------
+
+typedef struct
+{
+    uint64_t data[4];
+} Object_t;
+
+// Context of a client, as a server component would keep it
+struct Client
+{
+    std::mutex lock;
+    HandleMgr_t handleMgr;
+    ConcurrentHandleMgr_t concHandleMgr;
+    HandleMgr_Handle_t buffer[MAX_HANDLES_PER_CLIENT];
+    ConcurrentHandleMgr_Slot_t slots[MAX_HANDLES_PER_CLIENT];
+    Object_t objects[MAX_HANDLES_PER_CLIENT];
+};
+
+static Config cfg;
+static std::vector<Client> clients;
+static Object_t bogus[MAX_HANDLES_PER_CLIENT];
+static ContextMgr_t ctxMgr;
+
+static OS_Error_t
+initClient(
+    const ContextMgr_CID_t cid,
+    void**                 mem)
+{
+    Client* client = &clients[cid];
+
+    HandleMgr_init(&client->handleMgr, client->buffer, sizeof(client->buffer),
+                   NULL);
+    ConcurrentHandleMgr_init(&client->concHandleMgr, client->slots,
+                             sizeof(client->slots), NULL, NULL, NULL);
+    for (size_t i = 0; i < cfg.handles; i++)
+    {
+        HandleMgr_add(&client->handleMgr, &client->objects[i]);
+        ConcurrentHandleMgr_add(&client->concHandleMgr, &client->objects[i]);
+    }
+
+    *mem = client;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+freeClient(
+    const ContextMgr_CID_t cid,
+    void*                  mem)
+{
+    Client* client = static_cast<Client*>(mem);
+
+    (void) cid;
+    HandleMgr_free(&client->handleMgr);
+    ConcurrentHandleMgr_free(&client->concHandleMgr);
+
+    return OS_SUCCESS;
+}
+
+static const ContextMgr_MemoryFuncs_t fns =
+{
+    .init = initClient,
+    .free = freeClient
+};
+
+static void
+doWork(void)
+{
+    if (cfg.workNs > 0)
+    {
+        auto until = std::chrono::steady_clock::now() +
+                     std::chrono::nanoseconds(cfg.workNs);
+        while (std::chrono::steady_clock::now() < until)
+        {
+            // Busy
+        }
+    }
+}
+
+// Replace an object, i.e. remove and re-add its handle; in the end, the
+// object is always registered again, so both modes see the same share of
+// invalid requests
+static void
+replaceObject(
+    Client*            client,
+    HandleMgr_Handle_t h)
+{
+    if (cfg.lockFree)
+    {
+        // If another thread is replacing the object right now, it also
+        // re-adds it
+        if (ConcurrentHandleMgr_remove(&client->concHandleMgr, h) != OS_SUCCESS)
+        {
+            return;
+        }
+        // The handle can't be added again while requests still hold it, so
+        // wait for them to release it; they can't acquire it anymore, so this
+        // does not take long. The waiting counts towards the latency of the
+        // churn, just as waiting for the mutex does in locked mode.
+        while (ConcurrentHandleMgr_add(&client->concHandleMgr, h) ==
+               OS_ERROR_OPERATION_DENIED)
+        {
+            std::this_thread::yield();
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard(client->lock);
+        HandleMgr_remove(&client->handleMgr, h);
+        HandleMgr_add(&client->handleMgr, h);
+    }
+}
+
+// Returns true if the handle was valid
+static bool
+handleRequest(
+    Client*            client,
+    HandleMgr_Handle_t h)
+{
+    if (cfg.lockFree)
+    {
+        if (ConcurrentHandleMgr_acquire(&client->concHandleMgr, h) == NULL)
+        {
+            return false;
+        }
+        doWork();
+        ConcurrentHandleMgr_release(&client->concHandleMgr, h);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard(client->lock);
+        if (HandleMgr_validate(&client->handleMgr, h) == NULL)
+        {
+            return false;
+        }
+        doWork();
+    }
+
+    return true;
+}
+
+struct WorkerStats
+{
+    Histogram latency;
+    uint64_t valid = 0;
+    uint64_t invalid = 0;
+    uint64_t replaced = 0;
+    uint64_t churns = 0;
+    uint64_t disconnects = 0;
+};
+
+static void
+worker(
+    size_t                   id,
+    const std::atomic<bool>* done,
+    WorkerStats*             stats)
+{
+    auto seq = bench::makeSequence(cfg.dist, cfg.clients, 1000 + id);
+    std::mt19937 rng(id);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    std::uniform_int_distribution<size_t> obj(0, cfg.handles - 1);
+    size_t i = 0;
+    void* ctx;
+
+    while (!done->load(std::memory_order_relaxed))
+    {
+        ContextMgr_CID_t cid = seq[i++ & (bench::SEQUENCE_LEN - 1)];
+        double r = uni(rng);
+        size_t o = obj(rng);
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (ContextMgr_get(&ctxMgr, cid, &ctx) != OS_SUCCESS)
+        {
+            fprintf(stderr, "ContextMgr_get() failed for CID=%u\n", cid);
+            abort();
+        }
+        Client* client = static_cast<Client*>(ctx);
+
+        if (r < cfg.disconnect)
+        {
+            for (size_t j = 0; j < cfg.handles; j++)
+            {
+                replaceObject(client, &client->objects[j]);
+            }
+            stats->disconnects++;
+        }
+        else if (r < cfg.disconnect + cfg.churn)
+        {
+            replaceObject(client, &client->objects[o]);
+            stats->churns++;
+        }
+        else
+        {
+            bool isBogus = r < cfg.disconnect + cfg.churn + cfg.invalid;
+            if (handleRequest(client, isBogus ? &bogus[o] : &client->objects[o]))
+            {
+                stats->valid++;
+            }
+            else if (isBogus)
+            {
+                stats->invalid++;
+            }
+            else
+            {
+                // In lockfree mode, a request may come in between removing
+                // and re-adding the handle of an object which is replaced
+                stats->replaced++;
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        stats->latency.record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                end - start).count());
+    }
+}
+
+// Main ------------------------------------------------------------------------
+
+int
+main(
+    int    argc,
+    char** argv)
+{
+    std::vector<std::thread> threads;
+    std::vector<WorkerStats> stats;
+    std::atomic<bool> done(false);
+    WorkerStats total;
+    void* ctx;
+
+    if (!parseArgs(argc, argv, cfg))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Connect all clients before the workers start
+    clients = std::vector<Client>(cfg.clients);
+    if (ContextMgr_init(&ctxMgr, &fns, cfg.clients) != OS_SUCCESS)
+    {
+        fprintf(stderr, "ContextMgr_init() failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < cfg.clients; i++)
+    {
+        ContextMgr_get(&ctxMgr, i, &ctx);
+    }
+
+    stats = std::vector<WorkerStats>(cfg.threads);
+    for (size_t i = 0; i < cfg.threads; i++)
+    {
+        threads.emplace_back(worker, i, &done, &stats[i]);
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(cfg.duration));
+    done = true;
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    for (auto& s : stats)
+    {
+        total.latency.merge(s.latency);
+        total.valid       += s.valid;
+        total.invalid     += s.invalid;
+        total.replaced    += s.replaced;
+        total.churns      += s.churns;
+        total.disconnects += s.disconnects;
+    }
+
+    printf("mode:        %s\n", cfg.lockFree ? "lockfree" : "locked");
+    printf("threads:     %zu\n", cfg.threads);
+    printf("clients:     %zu (%s)\n", cfg.clients,
+           bench::distributionNames[cfg.dist]);
+    printf("handles:     %zu per client\n", cfg.handles);
+    printf("requests:    %llu (%llu valid, %llu invalid, %llu while replaced, "
+           "%llu churn, %llu disconnect)\n",
+           (unsigned long long) total.latency.count(),
+           (unsigned long long) total.valid,
+           (unsigned long long) total.invalid,
+           (unsigned long long) total.replaced,
+           (unsigned long long) total.churns,
+           (unsigned long long) total.disconnects);
+    printf("throughput:  %.0f req/s\n", total.latency.count() / cfg.duration);
+    printf("latency:     p50=%lluns p99=%lluns p999=%lluns max=%lluns\n",
+           (unsigned long long) total.latency.percentile(0.5),
+           (unsigned long long) total.latency.percentile(0.99),
+           (unsigned long long) total.latency.percentile(0.999),
+           (unsigned long long) total.latency.max());
+
+    ContextMgr_free(&ctxMgr);
+
+    return 0;
+}
@@ -0,0 +1,533 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_server/ConcurrentHandleMgr.h"
+#include <stdint.h>
+}
+
+class Test_ConcurrentHandleMgr : public testing::Test
+{
+    protected:
+};
+
+#define NUM_HANDLES 10
+#define NUM_THREADS 4
+
+// Keep track of lock/unlock
+static std::mutex mtx;
+static size_t lockNum = 0;
+
+// Keep track of deferred releases
+static std::atomic<size_t> releaseNum(0);
+static HandleMgr_Handle_t lastReleased = NULL;
+
+// Private functions -----------------------------------------------------------
+
+static void
+lockMgr(void)
+{
+    mtx.lock();
+    lockNum++;
+}
+
+static void
+unlockMgr(void)
+{
+    mtx.unlock();
+}
+
+static void
+releaseHandle(
+    HandleMgr_Handle_t handle)
+{
+    releaseNum++;
+    lastReleased = handle;
+}
+
+const ConcurrentHandleMgr_LockFuncs_t fns =
+{
+    .lock   = lockMgr,
+    .unlock = unlockMgr
+};
+
+// Test functions --------------------------------------------------------------
+
+TEST(Test_ConcurrentHandleMgr, init_free_pos)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    size_t numEl = NUM_HANDLES - 1;
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), &numEl,
+                                                   NULL, NULL));
+    ASSERT_EQ(numEl, NUM_HANDLES);
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   &fns, NULL));
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, init_neg)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    ConcurrentHandleMgr_LockFuncs_t myFns;
+    size_t numEl = NUM_HANDLES + 1;
+
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ConcurrentHandleMgr_init(NULL, buffer, sizeof(buffer), NULL,
+                                       NULL, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ConcurrentHandleMgr_init(&hMgr, NULL, sizeof(buffer), NULL,
+                                       NULL, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ConcurrentHandleMgr_init(&hMgr, buffer, 0, NULL, NULL, NULL));
+
+    // Buffer too small
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              ConcurrentHandleMgr_init(&hMgr, buffer, sizeof(buffer), &numEl,
+                                       NULL, NULL));
+
+    // Incomplete callbacks
+    myFns = fns;
+    myFns.lock = NULL;
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ConcurrentHandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL,
+                                       &myFns, NULL));
+    myFns = fns;
+    myFns.unlock = NULL;
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ConcurrentHandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL,
+                                       &myFns, NULL));
+}
+
+TEST(Test_ConcurrentHandleMgr, free_neg)
+{
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ConcurrentHandleMgr_free(NULL));
+}
+
+TEST(Test_ConcurrentHandleMgr, add_pos)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    size_t numEl = NUM_HANDLES;
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), &numEl,
+                                                   NULL, NULL));
+
+    for (size_t i = 0; i < numEl; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  ConcurrentHandleMgr_add(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+        // Handle was really added
+        ASSERT_EQ((void*) (i + 1),
+                  ConcurrentHandleMgr_validate(&hMgr,
+                                               (HandleMgr_Handle_t) (i + 1)));
+    }
+    // test duplicates avoidance
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED,
+              ConcurrentHandleMgr_add(&hMgr, (HandleMgr_Handle_t) NUM_HANDLES));
+    // test limit exceeded
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              ConcurrentHandleMgr_add(&hMgr,
+                                      (HandleMgr_Handle_t) (NUM_HANDLES + 1)));
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, add_neg)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, NULL));
+
+    // Empty ctx
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ConcurrentHandleMgr_add(
+                  NULL, (HandleMgr_Handle_t) 1));
+    // NULL handle
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ConcurrentHandleMgr_add(&hMgr, NULL));
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, addOnSuccess_neg)
+{
+    ConcurrentHandleMgr_t hMgr;
+    HandleMgr_Handle_t h = (HandleMgr_Handle_t) 1;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, NULL));
+
+    // Input error != OS_SUCCESS
+    ASSERT_EQ(OS_ERROR_ABORTED, ConcurrentHandleMgr_addOnSuccess(
+                  &hMgr, OS_ERROR_ABORTED,  &h));
+    // NULL handle pointer
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ConcurrentHandleMgr_addOnSuccess(
+                  &hMgr, OS_SUCCESS, NULL));
+    ASSERT_EQ((void*)0, ConcurrentHandleMgr_validate(&hMgr, h));
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, remove_pos)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    size_t numEl = NUM_HANDLES;
+
+    lockNum = 0;
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), &numEl,
+                                                   &fns, NULL));
+
+    for (size_t i = 0; i < numEl; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  ConcurrentHandleMgr_add(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+    }
+
+    ASSERT_EQ(OS_SUCCESS,
+              ConcurrentHandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 1));
+    // Handle was really removed
+    ASSERT_EQ((void*)0,
+              ConcurrentHandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 1));
+    // Free slot is re-used
+    ASSERT_EQ(OS_SUCCESS,
+              ConcurrentHandleMgr_add(&hMgr,
+                                      (HandleMgr_Handle_t) (NUM_HANDLES + 1)));
+    ASSERT_EQ((void*) (NUM_HANDLES + 1),
+              ConcurrentHandleMgr_validate(&hMgr,
+                                           (HandleMgr_Handle_t) (NUM_HANDLES + 1)));
+
+    // Remove everything from the back
+    for (size_t i = numEl; i > 1; i--)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  ConcurrentHandleMgr_remove(&hMgr, (HandleMgr_Handle_t) i));
+    }
+    ASSERT_EQ(OS_SUCCESS,
+              ConcurrentHandleMgr_remove(&hMgr,
+                                         (HandleMgr_Handle_t) (NUM_HANDLES + 1)));
+    ASSERT_EQ(0, hMgr.used);
+
+    // Every add/remove went through the lock callbacks
+    ASSERT_EQ(2 * (numEl + 1), lockNum);
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, remove_neg)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, NULL));
+
+    // Empty ctx
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ConcurrentHandleMgr_remove(
+                  NULL, (HandleMgr_Handle_t) 1));
+    // NULL handle
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ConcurrentHandleMgr_remove(
+                  &hMgr, NULL));
+    // Handle was never added
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE, ConcurrentHandleMgr_remove(
+                  &hMgr, (HandleMgr_Handle_t) 1));
+    // Input error != OS_SUCCESS
+    ASSERT_EQ(OS_ERROR_ABORTED, ConcurrentHandleMgr_removeOnSuccess(
+                  &hMgr, OS_ERROR_ABORTED, (HandleMgr_Handle_t) 1));
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, validate_concurrent_pos)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    std::vector<std::thread> readers;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> errors(0);
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, NULL));
+
+    // Handle 1 stays in the manager all the time, so it must always validate
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_add(&hMgr, (HandleMgr_Handle_t) 1));
+
+    for (size_t i = 0; i < NUM_THREADS; i++)
+    {
+        readers.emplace_back([&]()
+        {
+            while (!done.load())
+            {
+                if (ConcurrentHandleMgr_validate(&hMgr,
+                                                 (HandleMgr_Handle_t) 1) == NULL)
+                {
+                    errors++;
+                }
+                // Handle 0xdead is never added
+                if (ConcurrentHandleMgr_validate(&hMgr,
+                                                 (HandleMgr_Handle_t) 0xdead) != NULL)
+                {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    // Churn other handles while readers are validating; a failure must not
+    // return from the test before the readers are joined, so don't ASSERT
+    for (size_t n = 0; n < 10000 && !HasFailure(); n++)
+    {
+        for (size_t i = 2; i <= NUM_HANDLES; i++)
+        {
+            EXPECT_EQ(OS_SUCCESS,
+                      ConcurrentHandleMgr_add(&hMgr, (HandleMgr_Handle_t) i));
+        }
+        for (size_t i = 2; i <= NUM_HANDLES; i++)
+        {
+            EXPECT_EQ(OS_SUCCESS,
+                      ConcurrentHandleMgr_remove(&hMgr, (HandleMgr_Handle_t) i));
+        }
+    }
+
+    done = true;
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+    ASSERT_EQ(0, errors.load());
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, validate_reused_concurrent_pos)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[1];
+    std::vector<std::thread> readers;
+    std::atomic<uintptr_t> dead(0);
+    std::atomic<size_t> errors(0);
+    const uintptr_t numRounds = 200000;
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, NULL));
+
+    for (size_t i = 0; i < NUM_THREADS; i++)
+    {
+        readers.emplace_back([&]()
+        {
+            uintptr_t h;
+
+            // Once removed, a handle is never added again, so it must never
+            // validate, even if its slot is re-used while we look at it
+            while ((h = dead.load()) < numRounds)
+            {
+                if (h > 0 && ConcurrentHandleMgr_validate(
+                        &hMgr, (HandleMgr_Handle_t) h) != NULL)
+                {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    // There is only one slot, so every new handle re-uses the slot of the
+    // previous one as soon as that is released
+    for (uintptr_t h = 1; h <= numRounds && !HasFailure(); h++)
+    {
+        EXPECT_EQ(OS_SUCCESS,
+                  ConcurrentHandleMgr_add(&hMgr, (HandleMgr_Handle_t) h));
+        EXPECT_EQ((HandleMgr_Handle_t) h,
+                  ConcurrentHandleMgr_acquire(&hMgr, (HandleMgr_Handle_t) h));
+        EXPECT_EQ(OS_SUCCESS,
+                  ConcurrentHandleMgr_remove(&hMgr, (HandleMgr_Handle_t) h));
+        dead = h;
+        EXPECT_EQ(OS_SUCCESS,
+                  ConcurrentHandleMgr_release(&hMgr, (HandleMgr_Handle_t) h));
+    }
+
+    // Stop the readers, also if we bailed out early
+    dead = numRounds;
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+    ASSERT_EQ(0, errors.load());
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, acquire_release_pos)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    HandleMgr_Handle_t h = (HandleMgr_Handle_t) 1;
+
+    releaseNum = 0;
+    lastReleased = NULL;
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, releaseHandle));
+
+    // Remove without references releases right away
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_add(&hMgr, h));
+    ASSERT_EQ(h, ConcurrentHandleMgr_acquire(&hMgr, h));
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_release(&hMgr, h));
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_remove(&hMgr, h));
+    ASSERT_EQ(1, releaseNum.load());
+    ASSERT_EQ(h, lastReleased);
+
+    // Remove with references defers release to the last reference
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_add(&hMgr, h));
+    ASSERT_EQ(h, ConcurrentHandleMgr_acquire(&hMgr, h));
+    ASSERT_EQ(h, ConcurrentHandleMgr_acquire(&hMgr, h));
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_remove(&hMgr, h));
+    ASSERT_EQ(1, releaseNum.load());
+
+    // Removed handle is hidden, but can't be re-added until it is released
+    ASSERT_EQ((void*)0, ConcurrentHandleMgr_validate(&hMgr, h));
+    ASSERT_EQ((void*)0, ConcurrentHandleMgr_acquire(&hMgr, h));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE, ConcurrentHandleMgr_remove(&hMgr, h));
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED, ConcurrentHandleMgr_add(&hMgr, h));
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_release(&hMgr, h));
+    ASSERT_EQ(1, releaseNum.load());
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_release(&hMgr, h));
+    ASSERT_EQ(2, releaseNum.load());
+    ASSERT_EQ(0, hMgr.used);
+
+    // Slot can be used again
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_add(&hMgr, h));
+    ASSERT_EQ(h, ConcurrentHandleMgr_validate(&hMgr, h));
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, acquire_release_neg)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    HandleMgr_Handle_t h = (HandleMgr_Handle_t) 1;
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, NULL));
+
+    // Empty ctx or handle
+    ASSERT_EQ((void*)0, ConcurrentHandleMgr_acquire(NULL, h));
+    ASSERT_EQ((void*)0, ConcurrentHandleMgr_acquire(&hMgr, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ConcurrentHandleMgr_release(NULL, h));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ConcurrentHandleMgr_release(&hMgr, NULL));
+
+    // Handle was never added
+    ASSERT_EQ((void*)0, ConcurrentHandleMgr_acquire(&hMgr, h));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE, ConcurrentHandleMgr_release(&hMgr, h));
+
+    // Handle was never acquired
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_add(&hMgr, h));
+    ASSERT_EQ(OS_ERROR_INVALID_STATE, ConcurrentHandleMgr_release(&hMgr, h));
+    ASSERT_EQ(h, ConcurrentHandleMgr_validate(&hMgr, h));
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
+
+TEST(Test_ConcurrentHandleMgr, acquire_concurrent_pos)
+{
+    ConcurrentHandleMgr_t hMgr;
+    ConcurrentHandleMgr_Slot_t buffer[NUM_HANDLES];
+    std::vector<std::thread> workers;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> errors(0);
+    size_t n;
+
+    releaseNum = 0;
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_init(&hMgr, buffer,
+                                                   sizeof(buffer), NULL,
+                                                   NULL, releaseHandle));
+
+    for (size_t i = 0; i < NUM_THREADS; i++)
+    {
+        workers.emplace_back([&]()
+        {
+            while (!done.load())
+            {
+                for (size_t j = 1; j <= NUM_HANDLES; j++)
+                {
+                    HandleMgr_Handle_t h = (HandleMgr_Handle_t) j;
+                    if (ConcurrentHandleMgr_acquire(&hMgr, h) != NULL)
+                    {
+                        if (ConcurrentHandleMgr_release(&hMgr, h) != OS_SUCCESS)
+                        {
+                            errors++;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // Churn handles while workers are acquiring them; every handle must be
+    // released exactly once, no matter who dropped the last reference. A
+    // failure must not return from the test before the workers are joined,
+    // so don't ASSERT.
+    for (n = 0; n < 2000; n++)
+    {
+        for (size_t j = 1; j <= NUM_HANDLES; j++)
+        {
+            EXPECT_EQ(OS_SUCCESS,
+                      ConcurrentHandleMgr_add(&hMgr, (HandleMgr_Handle_t) j));
+        }
+        for (size_t j = 1; j <= NUM_HANDLES; j++)
+        {
+            EXPECT_EQ(OS_SUCCESS,
+                      ConcurrentHandleMgr_remove(&hMgr, (HandleMgr_Handle_t) j));
+        }
+        if (HasFailure())
+        {
+            break;
+        }
+        // Wait for all workers to drop their references, otherwise the next
+        // add() is (correctly) denied
+        while (releaseNum.load() < (n + 1) * NUM_HANDLES)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    done = true;
+    for (auto& t : workers)
+    {
+        t.join();
+    }
+    ASSERT_EQ(0, errors.load());
+    ASSERT_EQ(n * NUM_HANDLES, releaseNum.load());
+
+    ASSERT_EQ(OS_SUCCESS, ConcurrentHandleMgr_free(&hMgr));
+}
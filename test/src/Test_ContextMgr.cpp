@@ -27,6 +27,7 @@ typedef struct
 // Keep track of alloc/free
 static size_t initNum = 0;
 static size_t freeNum = 0;
+static bool failInit = false;
 
 // Private functions -----------------------------------------------------------
 
@@ -37,6 +38,11 @@ initClient(
 {
     ClientCtx_t* p;
 
+    if (failInit)
+    {
+        return OS_ERROR_ABORTED;
+    }
+
     p = (ClientCtx_t*) calloc(1, sizeof(ClientCtx_t));
     assert(p != NULL);
     p->cid = cid;
@@ -160,3 +166,94 @@ TEST(Test_ContextMgr, get_neg)
 
     ASSERT_EQ(OS_SUCCESS, ContextMgr_free(&hMgr));
 }
+
+TEST(Test_ContextMgr, initBounded_neg)
+{
+    ContextMgr_t hMgr;
+
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ContextMgr_initBounded(NULL, &fns, MAX_CLIENTS));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ContextMgr_initBounded(&hMgr, NULL, MAX_CLIENTS));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ContextMgr_initBounded(&hMgr, &fns, 0));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              ContextMgr_initBounded(&hMgr, &fns, 1025));
+}
+
+TEST(Test_ContextMgr, getBounded_pos)
+{
+    ContextMgr_t hMgr;
+    ClientCtx_t* ctx;
+
+    // Use dense as well as scattered CIDs
+    for (ContextMgr_CID_t step = 1; step <= 0x10001; step += 0x10000)
+    {
+        initNum = freeNum = 0;
+        ASSERT_EQ(OS_SUCCESS, ContextMgr_initBounded(&hMgr, &fns, 1024));
+
+        for (ContextMgr_CID_t i = 0; i < 1024; i++)
+        {
+            ASSERT_EQ(OS_SUCCESS,
+                      ContextMgr_get(&hMgr, i * step, (void**)&ctx));
+            ASSERT_EQ(ctx->cid, i * step);
+        }
+        ASSERT_EQ(initNum, 1024);
+
+        for (ContextMgr_CID_t i = 0; i < 1024; i++)
+        {
+            ASSERT_EQ(OS_SUCCESS,
+                      ContextMgr_get(&hMgr, i * step, (void**)&ctx));
+            ASSERT_EQ(ctx->cid, i * step);
+        }
+        ASSERT_EQ(initNum, 1024);
+
+        ASSERT_EQ(OS_SUCCESS, ContextMgr_free(&hMgr));
+        ASSERT_EQ(freeNum, 1024);
+    }
+}
+
+TEST(Test_ContextMgr, getBounded_neg)
+{
+    ContextMgr_t hMgr;
+    ClientCtx_t* ctx;
+
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_initBounded(&hMgr, &fns, 2));
+
+    // Try empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ContextMgr_get(NULL,  0, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, ContextMgr_get(&hMgr, 0, NULL));
+
+    // Try to get more contexts than allowed, even though there are more slots
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_get(&hMgr, 0, (void**)&ctx));
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_get(&hMgr, 1, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE, ContextMgr_get(&hMgr, 2, (void**)&ctx));
+
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_free(&hMgr));
+}
+
+TEST(Test_ContextMgr, get_initFails_neg)
+{
+    ContextMgr_t hMgr;
+    ClientCtx_t* ctx;
+
+    for (int bounded = 0; bounded <= 1; bounded++)
+    {
+        initNum = freeNum = 0;
+        ASSERT_EQ(OS_SUCCESS, bounded ? ContextMgr_initBounded(&hMgr, &fns, 1) :
+                  ContextMgr_init(&hMgr, &fns, 1));
+
+        // A failed init() must not use up the slot
+        failInit = true;
+        ASSERT_EQ(OS_ERROR_ABORTED, ContextMgr_get(&hMgr, 0, (void**)&ctx));
+        failInit = false;
+        ASSERT_EQ(OS_SUCCESS, ContextMgr_get(&hMgr, 1, (void**)&ctx));
+        ASSERT_EQ(ctx->cid, 1);
+        ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+                  ContextMgr_get(&hMgr, 0, (void**)&ctx));
+
+        ASSERT_EQ(OS_SUCCESS, ContextMgr_free(&hMgr));
+        ASSERT_EQ(initNum, 1);
+        ASSERT_EQ(freeNum, 1);
+    }
+}
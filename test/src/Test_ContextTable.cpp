@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include "lib_server/ContextTable.hpp"
+
+#include <vector>
+
+class Test_ContextTable : public testing::Test
+{
+    protected:
+};
+
+// Keep track of construction/destruction
+static size_t initNum = 0;
+static size_t freeNum = 0;
+
+// Dummy context which knows its client
+class ClientCtx
+{
+public:
+    ClientCtx(lib_server::WithCid, ContextMgr_CID_t cid) : cid(cid)
+    {
+        initNum++;
+    }
+    ~ClientCtx()
+    {
+        freeNum++;
+    }
+
+    ContextMgr_CID_t cid;
+};
+
+// Dummy context which does not
+typedef struct
+{
+    int counter;
+} PlainCtx_t;
+
+#define MAX_CLIENTS 8
+
+// Test functions --------------------------------------------------------------
+
+TEST(Test_ContextTable, get_pos)
+{
+    initNum = freeNum = 0;
+    {
+        lib_server::ContextTable<ClientCtx, MAX_CLIENTS> table;
+        ClientCtx* ctx;
+
+        // We should not have any contexts without calls to get()
+        ASSERT_EQ(0, initNum);
+
+        // Get all contexts, this should construct them
+        for (size_t i = 0; i < MAX_CLIENTS; i++)
+        {
+            ASSERT_NE(nullptr, ctx = table.get(i));
+            ASSERT_EQ(ctx->cid, i);
+        }
+        ASSERT_EQ(initNum, MAX_CLIENTS);
+
+        // Get contexts again, there should be no further construction
+        for (size_t i = 0; i < MAX_CLIENTS; i++)
+        {
+            ASSERT_NE(nullptr, ctx = table.get(i));
+            ASSERT_EQ(ctx->cid, i);
+        }
+        ASSERT_EQ(initNum, MAX_CLIENTS);
+        ASSERT_EQ(table.size(), MAX_CLIENTS);
+    }
+
+    // Destroying the table destroys all contexts as well
+    ASSERT_EQ(freeNum, MAX_CLIENTS);
+}
+
+TEST(Test_ContextTable, get_default_pos)
+{
+    lib_server::ContextTable<PlainCtx_t, MAX_CLIENTS> table;
+    PlainCtx_t* ctx;
+
+    // Contexts are value-initialized and kept per client
+    ASSERT_NE(nullptr, ctx = table.get(42));
+    ASSERT_EQ(0, ctx->counter);
+    ctx->counter++;
+    ASSERT_EQ(1, table.get(42)->counter);
+    ASSERT_EQ(0, table.get(43)->counter);
+}
+
+TEST(Test_ContextTable, get_noCid_pos)
+{
+    lib_server::ContextTable<std::vector<int>, MAX_CLIENTS> table;
+
+    // A constructor taking an integer is not passed the CID without opt-in
+    ASSERT_TRUE(table.get(42)->empty());
+}
+
+TEST(Test_ContextTable, get_neg)
+{
+    lib_server::ContextTable<ClientCtx, 2> table;
+
+    // Try to get more contexts than allowed
+    ASSERT_NE(nullptr, table.get(0));
+    ASSERT_NE(nullptr, table.get(1));
+    ASSERT_EQ(nullptr, table.get(2));
+}
@@ -241,3 +241,619 @@ TEST(Test_HandleMgr, validate_pos)
     ASSERT_EQ((void*)0, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 1));
     ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
 }
+
+TEST(Test_HandleMgr, initFilter_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    uint32_t filter[HandleMgr_SIZE_OF_FILTER(NUM_HANDLES) / sizeof(uint32_t)];
+    size_t numEl = NUM_HANDLES;
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), &numEl));
+
+    // Handles added before the filter is set up are taken over
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initFilter(&hMgr, filter, sizeof(filter)));
+    ASSERT_EQ((void*)1, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 1));
+
+    for (size_t i = 1; i < numEl; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_add(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+        // Handle was really added
+        ASSERT_EQ((void*) (i + 1),
+                  HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+    }
+    // test duplicates avoidance
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED,
+              HandleMgr_add(&hMgr, (HandleMgr_Handle_t) (NUM_HANDLES)));
+
+    // Removed handles must not pass, all others must still be there
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ((void*)0, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 1));
+    for (size_t i = 1; i < numEl; i++)
+    {
+        ASSERT_EQ((void*) (i + 1),
+                  HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+    }
+
+    // Unknown handles never pass, no matter if the filter rejects them
+    for (uintptr_t i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ((void*)0,
+                  HandleMgr_validate(&hMgr,
+                                     (HandleMgr_Handle_t) (0x10000 + i * 8)));
+    }
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, initFilter_neg)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    uint32_t filter[HandleMgr_SIZE_OF_FILTER(NUM_HANDLES) / sizeof(uint32_t)];
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initFilter(NULL, filter, sizeof(filter)));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initFilter(&hMgr, NULL, sizeof(filter)));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initFilter(&hMgr, filter, sizeof(uint32_t) - 1));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+// Keep track of alloc/free
+static size_t allocNum = 0;
+static size_t freeNum = 0;
+static bool allocFails = false;
+
+static void*
+allocMem(
+    size_t size)
+{
+    if (allocFails)
+    {
+        return NULL;
+    }
+    allocNum++;
+    return malloc(size);
+}
+
+static void
+freeMem(
+    void* mem)
+{
+    freeNum++;
+    free(mem);
+}
+
+const HandleMgr_MemoryFuncs_t memFns =
+{
+    .alloc = allocMem,
+    .free  = freeMem
+};
+
+TEST(Test_HandleMgr, initGrowable_pos)
+{
+    HandleMgr_t hMgr;
+    const size_t numEl = 10 * NUM_HANDLES;
+
+    allocNum = freeNum = 0;
+    allocFails = false;
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initGrowable(&hMgr, &memFns, 2));
+
+    for (size_t i = 0; i < numEl; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_add(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+    }
+    ASSERT_GE(hMgr.capacity, numEl);
+    // Memory was grown geometrically: 2, 4, ..., 128
+    ASSERT_EQ(7, allocNum);
+
+    // All handles survived growing
+    for (size_t i = 0; i < numEl; i++)
+    {
+        ASSERT_EQ((void*) (i + 1),
+                  HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+    }
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED,
+              HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 1));
+
+    // Removing handles shrinks memory again, but not below initial capacity
+    for (size_t i = 0; i < numEl; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) (i + 1)));
+    }
+    ASSERT_EQ(2, hMgr.capacity);
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+    ASSERT_EQ(allocNum, freeNum);
+}
+
+TEST(Test_HandleMgr, initGrowable_neg)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_MemoryFuncs_t myFns;
+
+    allocNum = freeNum = 0;
+    allocFails = false;
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initGrowable(NULL, &memFns, NUM_HANDLES));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initGrowable(&hMgr, NULL, NUM_HANDLES));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initGrowable(&hMgr, &memFns, 0));
+
+    // Empty callbacks
+    myFns = memFns;
+    myFns.alloc = NULL;
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initGrowable(&hMgr, &myFns, NUM_HANDLES));
+    myFns = memFns;
+    myFns.free = NULL;
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_initGrowable(&hMgr, &myFns, NUM_HANDLES));
+
+    // Buffer size would not fit into a size_t, nothing must be allocated
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_initGrowable(&hMgr, &memFns,
+                                     SIZE_MAX / sizeof(HandleMgr_Handle_t) + 1));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_initGrowable(&hMgr, &memFns, SIZE_MAX));
+    ASSERT_EQ(0, allocNum);
+
+    // Initial allocation fails
+    allocFails = true;
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_initGrowable(&hMgr, &memFns, NUM_HANDLES));
+
+    // Growing fails, but existing handles are kept
+    allocFails = false;
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initGrowable(&hMgr, &memFns, 1));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 1));
+    allocFails = true;
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 2));
+    ASSERT_EQ((void*)1, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 1));
+
+    allocFails = false;
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+    ASSERT_EQ(allocNum, freeNum);
+}
+
+TEST(Test_HandleMgr, setMode_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    // Added in an order which needs moving handles around
+    const uintptr_t values[NUM_HANDLES] = { 5, 1, 9, 3, 7, 2, 10, 4, 8, 6 };
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_SORTED));
+
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_add(&hMgr, (HandleMgr_Handle_t) values[i]));
+    }
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED,
+              HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 3));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 11));
+
+    // Handles are kept in order
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ((HandleMgr_Handle_t) (i + 1), buffer[i]);
+    }
+
+    // Only known handles are found, also beyond both ends
+    for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+    {
+        ASSERT_EQ((void*) i, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) i));
+    }
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 11));
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) UINTPTR_MAX));
+
+    // Removing keeps the order
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 6));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 10));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 6));
+    for (size_t i = 0; i < NUM_HANDLES - 4; i++)
+    {
+        ASSERT_LT(buffer[i], buffer[i + 1]);
+    }
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 6));
+    ASSERT_EQ((void*) 7, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 7));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, setMode_neg)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+
+    // Empty pointers and invalid mode
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_setMode(NULL, HandleMgr_MODE_SORTED));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_setMode(&hMgr, (HandleMgr_Mode_t) 42));
+
+    // Mode can't be changed once there are handles
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_ERROR_INVALID_STATE,
+              HandleMgr_setMode(&hMgr, HandleMgr_MODE_SORTED));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, addBatch_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    HandleMgr_Handle_t odd[]  = { (void*) 9, (void*) 1, (void*) 5, (void*) 3 };
+    HandleMgr_Handle_t even[] = { (void*) 10, (void*) 4, (void*) 2,
+                                  (void*) 8, (void*) 6 };
+
+    for (int mode = HandleMgr_MODE_LINEAR; mode <= HandleMgr_MODE_SORTED; mode++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_setMode(&hMgr, (HandleMgr_Mode_t) mode));
+
+        // Merge two batches into each other
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_addBatch(&hMgr, odd, 4));
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_addBatch(&hMgr, even, 5));
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 7));
+
+        for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+        {
+            ASSERT_EQ((void*) i,
+                      HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) i));
+        }
+        if (HandleMgr_MODE_SORTED == mode)
+        {
+            for (size_t i = 0; i < NUM_HANDLES; i++)
+            {
+                ASSERT_EQ((HandleMgr_Handle_t) (i + 1), buffer[i]);
+            }
+        }
+
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+    }
+}
+
+TEST(Test_HandleMgr, addBatch_neg)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    HandleMgr_Handle_t batch[NUM_HANDLES];
+    HandleMgr_Handle_t dup[]    = { (void*) 3, (void*) 2, (void*) 3 };
+    HandleMgr_Handle_t known[]  = { (void*) 2, (void*) 1 };
+    HandleMgr_Handle_t holes[]  = { (void*) 2, NULL };
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_SORTED));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 1));
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, HandleMgr_addBatch(NULL, dup, 3));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, HandleMgr_addBatch(&hMgr, NULL, 3));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, HandleMgr_addBatch(&hMgr, dup, 0));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, HandleMgr_addBatch(&hMgr, holes, 2));
+
+    // Duplicates within the batch or with known handles
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED, HandleMgr_addBatch(&hMgr, dup, 3));
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED, HandleMgr_addBatch(&hMgr, known, 2));
+
+    // Too many handles
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        batch[i] = (HandleMgr_Handle_t) (i + 2);
+    }
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_addBatch(&hMgr, batch, NUM_HANDLES));
+
+    // Nothing was added by any of the above
+    ASSERT_EQ((void*) 1, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 1));
+    for (uintptr_t i = 2; i <= NUM_HANDLES + 1; i++)
+    {
+        ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) i));
+    }
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, removeBatch_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[2 * NUM_HANDLES];
+    HandleMgr_Handle_t first[]  = { (void*) 9, (void*) 2, (void*) 5,
+                                    (void*) 3 };
+    HandleMgr_Handle_t second[] = { (void*) 10, (void*) 1, (void*) 4,
+                                    (void*) 8, (void*) 7, (void*) 6 };
+    HandleMgr_Handle_t remaining[] = { (void*) 1, (void*) 4, (void*) 6,
+                                       (void*) 7, (void*) 8, (void*) 10 };
+    HandleMgr_MemoryFuncs_t memFns = { .alloc = malloc, .free = free };
+    HandleMgr_Handle_t batch[8 * NUM_HANDLES];
+
+    for (int mode = HandleMgr_MODE_LINEAR; mode <= HandleMgr_MODE_TRANSPOSE;
+         mode++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_setMode(&hMgr, (HandleMgr_Mode_t) mode));
+        for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+        {
+            ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) i));
+        }
+
+        // Take out some handles from the middle; apart from the bounded mode,
+        // the remaining ones keep their order
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_removeBatch(&hMgr, first, 4));
+        if (HandleMgr_MODE_BOUNDED != mode)
+        {
+            for (size_t i = 0; i < 6; i++)
+            {
+                ASSERT_EQ(remaining[i], buffer[i]);
+            }
+        }
+        for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+        {
+            bool removed = (i == 2 || i == 3 || i == 5 || i == 9);
+            ASSERT_EQ(removed ? NULL : (void*) i,
+                      HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) i));
+        }
+
+        // Take out the rest, then the manager is empty
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_removeBatch(&hMgr, second, 6));
+        for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+        {
+            ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) i));
+        }
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_setMode(&hMgr, HandleMgr_MODE_LINEAR));
+
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+    }
+
+    // A growable manager shrinks as far as it can in one go
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initGrowable(&hMgr, &memFns, 4));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_SORTED));
+    for (size_t i = 0; i < 8 * NUM_HANDLES; i++)
+    {
+        batch[i] = (HandleMgr_Handle_t) (i + 1);
+    }
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_addBatch(&hMgr, batch, 8 * NUM_HANDLES));
+    ASSERT_EQ(128, hMgr.capacity);
+    ASSERT_EQ(OS_SUCCESS,
+              HandleMgr_removeBatch(&hMgr, batch, 8 * NUM_HANDLES - 2));
+    ASSERT_EQ(8, hMgr.capacity);
+    ASSERT_EQ((void*) 79, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 79));
+    ASSERT_EQ((void*) 80, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 80));
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 78));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, removeBatch_neg)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    uint32_t filter[HandleMgr_SIZE_OF_FILTER(NUM_HANDLES) / sizeof(uint32_t)];
+    HandleMgr_Handle_t dup[]     = { (void*) 3, (void*) 2, (void*) 3 };
+    HandleMgr_Handle_t unknown[] = { (void*) 2, (void*) 11 };
+    HandleMgr_Handle_t holes[]   = { (void*) 2, NULL };
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_SORTED));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initFilter(&hMgr, filter, sizeof(filter)));
+    for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) i));
+    }
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, HandleMgr_removeBatch(NULL, dup, 3));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_removeBatch(&hMgr, NULL, 3));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_removeBatch(&hMgr, dup, 0));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              HandleMgr_removeBatch(&hMgr, holes, 2));
+
+    // Duplicates within the batch or unknown handles
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE, HandleMgr_removeBatch(&hMgr, dup, 3));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              HandleMgr_removeBatch(&hMgr, unknown, 2));
+
+    // Nothing was removed by any of the above
+    for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+    {
+        ASSERT_EQ((void*) i, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) i));
+    }
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, bounded_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[8 * NUM_HANDLES];
+    HandleMgr_Handle_t batch[NUM_HANDLES];
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_BOUNDED));
+
+    // Fill half of the table with aligned handles, like real pointers
+    for (uintptr_t i = 1; i <= 4 * NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_add(&hMgr, (HandleMgr_Handle_t) (i * 16)));
+    }
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED,
+              HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 16));
+    for (uintptr_t i = 1; i <= 4 * NUM_HANDLES; i++)
+    {
+        ASSERT_EQ((void*) (i * 16),
+                  HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) (i * 16)));
+    }
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 8));
+
+    // Remove every other handle, the rest must still be found
+    for (uintptr_t i = 1; i <= 4 * NUM_HANDLES; i += 2)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) (i * 16)));
+    }
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 16));
+    for (uintptr_t i = 1; i <= 4 * NUM_HANDLES; i++)
+    {
+        ASSERT_EQ((i % 2) ? NULL : (void*) (i * 16),
+                  HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) (i * 16)));
+    }
+
+    // Batches work as well
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        batch[i] = (HandleMgr_Handle_t) ((i + 1) * 8 + 1024);
+    }
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_addBatch(&hMgr, batch, NUM_HANDLES));
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(batch[i], HandleMgr_validate(&hMgr, batch[i]));
+    }
+
+    // Once empty, the mode can be changed again
+    for (uintptr_t i = 2; i <= 4 * NUM_HANDLES; i += 2)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) (i * 16)));
+    }
+    ASSERT_EQ(OS_ERROR_INVALID_STATE,
+              HandleMgr_setMode(&hMgr, HandleMgr_MODE_LINEAR));
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, batch[i]));
+    }
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_LINEAR));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 16));
+    ASSERT_EQ((void*) 16, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 16));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, bounded_neg)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[4];
+    uint32_t filter[4];
+    HandleMgr_MemoryFuncs_t memFns = { .alloc = malloc, .free = free };
+    HandleMgr_Handle_t batch[] = { (void*) 32, (void*) 48, (void*) 64,
+                                   (void*) 80 };
+
+    // Growable handle managers or filters can't be combined with this mode
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initGrowable(&hMgr, &memFns, 4));
+    ASSERT_EQ(OS_ERROR_NOT_SUPPORTED,
+              HandleMgr_setMode(&hMgr, HandleMgr_MODE_BOUNDED));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initFilter(&hMgr, filter, sizeof(filter)));
+    ASSERT_EQ(OS_ERROR_NOT_SUPPORTED,
+              HandleMgr_setMode(&hMgr, HandleMgr_MODE_BOUNDED));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_BOUNDED));
+    ASSERT_EQ(OS_ERROR_NOT_SUPPORTED,
+              HandleMgr_initFilter(&hMgr, filter, sizeof(filter)));
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, HandleMgr_add(&hMgr, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, HandleMgr_remove(&hMgr, NULL));
+
+    // The table is smaller than a bucket, so the batch can't fit next to the
+    // handle already there; none of it must remain
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 16));
+    ASSERT_EQ(OS_ERROR_INVALID_STATE,
+              HandleMgr_setMode(&hMgr, HandleMgr_MODE_SORTED));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_addBatch(&hMgr, batch, 4));
+    for (size_t i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, batch[i]));
+    }
+
+    // Fill it up
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_addBatch(&hMgr, batch, 3));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              HandleMgr_add(&hMgr, (HandleMgr_Handle_t) 96));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_HandleMgr, transpose_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    uint32_t filter[HandleMgr_SIZE_OF_FILTER(NUM_HANDLES) / sizeof(uint32_t)];
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_setMode(&hMgr, HandleMgr_MODE_TRANSPOSE));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_initFilter(&hMgr, filter, sizeof(filter)));
+
+    // New handles are added at the back
+    for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, (HandleMgr_Handle_t) i));
+    }
+    ASSERT_EQ((void*) 1, buffer[0]);
+    ASSERT_EQ((void*) NUM_HANDLES, buffer[NUM_HANDLES - 1]);
+
+    // Validated handles move up by one, the others stay where they are
+    ASSERT_EQ((void*) 7, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 7));
+    ASSERT_EQ((void*) 3, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 3));
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 11));
+    ASSERT_EQ((void*) 1, buffer[0]);
+    ASSERT_EQ((void*) 3, buffer[1]);
+    ASSERT_EQ((void*) 2, buffer[2]);
+    ASSERT_EQ((void*) 7, buffer[5]);
+    ASSERT_EQ((void*) 6, buffer[6]);
+
+    // Repeated hits move a handle to the front, but not beyond
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ((void*) 7, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 7));
+    }
+    ASSERT_EQ((void*) 7, buffer[0]);
+    ASSERT_EQ((void*) 1, buffer[1]);
+    ASSERT_EQ((void*) 3, buffer[2]);
+
+    // Removing keeps the order
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, (HandleMgr_Handle_t) 4));
+    ASSERT_EQ((void*) 7, buffer[0]);
+    ASSERT_EQ((void*) 3, buffer[1]);
+    ASSERT_EQ((void*) 2, buffer[2]);
+    ASSERT_EQ((void*) 5, buffer[3]);
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ((void*) 10, HandleMgr_validate(&hMgr, (HandleMgr_Handle_t) 10));
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
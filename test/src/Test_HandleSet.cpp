@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include "lib_server/HandleSet.hpp"
+
+class Test_HandleSet : public testing::Test
+{
+    protected:
+};
+
+#define NUM_HANDLES 10
+
+// Dummy object type
+typedef struct
+{
+    int id;
+} Object_t;
+
+static Object_t objects[NUM_HANDLES + 1];
+
+// Same memory as the C version needs
+static_assert(lib_server::HandleSet<Object_t, NUM_HANDLES>::sizeOfBuffer ==
+              HandleMgr_SIZE_OF_BUFFER(NUM_HANDLES));
+
+// Test functions --------------------------------------------------------------
+
+TEST(Test_HandleSet, add_pos)
+{
+    lib_server::HandleSet<Object_t, NUM_HANDLES> set;
+
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS, set.add(&objects[i]));
+        // Handle was really added
+        ASSERT_EQ(&objects[i], set.validate(&objects[i]));
+    }
+    ASSERT_EQ(NUM_HANDLES, set.size());
+
+    // test duplicates avoidance
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED, set.add(&objects[0]));
+    // test limit exceeded
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE, set.add(&objects[NUM_HANDLES]));
+}
+
+TEST(Test_HandleSet, add_neg)
+{
+    lib_server::HandleSet<Object_t, NUM_HANDLES> set;
+
+    // NULL handle
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, set.add(nullptr));
+}
+
+TEST(Test_HandleSet, remove_pos)
+{
+    lib_server::HandleSet<Object_t, NUM_HANDLES> set;
+
+    for (size_t i = 0; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS, set.add(&objects[i]));
+    }
+
+    ASSERT_EQ(OS_SUCCESS, set.remove(&objects[0]));
+    // Handle was really removed
+    ASSERT_EQ(nullptr, set.validate(&objects[0]));
+    // Others are still there
+    for (size_t i = 1; i < NUM_HANDLES; i++)
+    {
+        ASSERT_EQ(&objects[i], set.validate(&objects[i]));
+    }
+    // try to re-add
+    ASSERT_EQ(OS_SUCCESS, set.add(&objects[0]));
+    ASSERT_EQ(&objects[0], set.validate(&objects[0]));
+}
+
+TEST(Test_HandleSet, remove_neg)
+{
+    lib_server::HandleSet<Object_t, NUM_HANDLES> set;
+
+    // NULL handle
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, set.remove(nullptr));
+    // Handle was never added
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE, set.remove(&objects[0]));
+}
+
+TEST(Test_HandleSet, validate_neg)
+{
+    lib_server::HandleSet<Object_t, NUM_HANDLES> set;
+
+    // NULL pointers simply pass through
+    ASSERT_EQ(nullptr, set.validate(nullptr));
+    ASSERT_EQ(nullptr, set.validate(&objects[0]));
+}
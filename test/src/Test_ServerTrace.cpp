@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "lib_server/ContextMgr.h"
+#include "lib_server/HandleMgr.h"
+#include "lib_server/ServerTrace.h"
+}
+
+class Test_ServerTrace : public testing::Test
+{
+    protected:
+};
+
+#define NUM_HANDLES 4
+
+#if defined(LIB_SERVER_TRACE)
+
+struct Record
+{
+    size_t thread;
+    ServerTrace_Event_t event;
+};
+
+// Private functions -----------------------------------------------------------
+
+static void
+collect(
+    size_t                     thread,
+    const ServerTrace_Event_t* event,
+    void*                      ctx)
+{
+    static_cast<std::vector<Record>*>(ctx)->push_back({ thread, *event });
+}
+
+static std::vector<Record>
+dump()
+{
+    std::vector<Record> records;
+
+    ServerTrace_dump(collect, &records);
+
+    return records;
+}
+
+static std::atomic<uint64_t> ticks(0);
+
+static uint64_t
+fakeClock(void)
+{
+    // Every call advances the time, so each operation takes one tick
+    return ticks++;
+}
+
+static OS_Error_t
+initClient(
+    const ContextMgr_CID_t cid,
+    void**                 mem)
+{
+    (void) cid;
+
+    *mem = malloc(1);
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+freeClient(
+    const ContextMgr_CID_t cid,
+    void*                  mem)
+{
+    (void) cid;
+
+    free(mem);
+
+    return OS_SUCCESS;
+}
+
+const ContextMgr_MemoryFuncs_t fns =
+{
+    .init = initClient,
+    .free = freeClient
+};
+
+// Test functions --------------------------------------------------------------
+
+TEST(Test_ServerTrace, ContextMgr_pos)
+{
+    ContextMgr_t cMgr;
+    void* ctx;
+
+    ServerTrace_setClock(fakeClock);
+    ServerTrace_reset();
+
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_init(&cMgr, &fns, 1));
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_get(&cMgr, 7, &ctx));
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_get(&cMgr, 7, &ctx));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE, ContextMgr_get(&cMgr, 8, &ctx));
+    ASSERT_EQ(OS_SUCCESS, ContextMgr_free(&cMgr));
+
+    auto records = dump();
+    const ServerTrace_Op_t ops[] =
+    {
+        ServerTrace_CONTEXTMGR_INIT,
+        ServerTrace_CONTEXTMGR_ALLOC,   // nested in the first get()
+        ServerTrace_CONTEXTMGR_GET,
+        ServerTrace_CONTEXTMGR_GET,
+        ServerTrace_CONTEXTMGR_GET,
+        ServerTrace_CONTEXTMGR_FREE,
+    };
+    ASSERT_EQ(records.size(), sizeof(ops) / sizeof(ops[0]));
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        ASSERT_EQ(records[i].event.op, ops[i]);
+        ASSERT_EQ(records[i].event.self, &cMgr);
+    }
+    ASSERT_EQ(records[1].event.arg, 7);
+    ASSERT_EQ(records[4].event.arg, 8);
+    ASSERT_EQ(records[4].event.result, OS_ERROR_INSUFFICIENT_SPACE);
+
+    // The get() which allocated took longer than the ALLOC inside of it
+    ASSERT_GT(records[2].event.duration, records[1].event.duration);
+    ASSERT_LE(records[2].event.start, records[1].event.start);
+
+    ASSERT_STREQ("ContextMgr_get",
+                 ServerTrace_getOpName(ServerTrace_CONTEXTMGR_GET));
+    ASSERT_STREQ("unknown", ServerTrace_getOpName(ServerTrace_NUM_OPS));
+}
+
+TEST(Test_ServerTrace, HandleMgr_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    HandleMgr_Handle_t h = (HandleMgr_Handle_t) 0x1000;
+
+    ServerTrace_reset();
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_add(&hMgr, h));
+    ASSERT_EQ(h, HandleMgr_validate(&hMgr, h));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_remove(&hMgr, h));
+    ASSERT_EQ(NULL, HandleMgr_validate(&hMgr, h));
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+
+    auto records = dump();
+    ASSERT_EQ(6, records.size());
+    ASSERT_EQ(ServerTrace_HANDLEMGR_INIT, records[0].event.op);
+    ASSERT_EQ(ServerTrace_HANDLEMGR_ADD, records[1].event.op);
+    ASSERT_EQ((uintptr_t) h, records[1].event.arg);
+    ASSERT_EQ(ServerTrace_HANDLEMGR_VALIDATE, records[2].event.op);
+    ASSERT_EQ(OS_SUCCESS, records[2].event.result);
+    ASSERT_EQ(ServerTrace_HANDLEMGR_REMOVE, records[3].event.op);
+    ASSERT_EQ(ServerTrace_HANDLEMGR_VALIDATE, records[4].event.op);
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE, records[4].event.result);
+    ASSERT_EQ(ServerTrace_HANDLEMGR_FREE, records[5].event.op);
+}
+
+TEST(Test_ServerTrace, ring_pos)
+{
+    HandleMgr_t hMgr;
+    HandleMgr_Handle_t buffer[NUM_HANDLES];
+    HandleMgr_Handle_t h = (HandleMgr_Handle_t) 0x1000;
+    const size_t numEvents = LIB_SERVER_TRACE_EVENTS + 10;
+
+    ServerTrace_reset();
+
+    // Only the most recent events are kept
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL));
+    for (size_t i = 1; i < numEvents; i++)
+    {
+        HandleMgr_validate(&hMgr, h);
+    }
+    auto records = dump();
+    ASSERT_EQ(LIB_SERVER_TRACE_EVENTS, records.size());
+    for (auto& r : records)
+    {
+        ASSERT_EQ(ServerTrace_HANDLEMGR_VALIDATE, r.event.op);
+    }
+    for (size_t i = 1; i < records.size(); i++)
+    {
+        ASSERT_LT(records[i - 1].event.start, records[i].event.start);
+    }
+
+    ASSERT_EQ(OS_SUCCESS, HandleMgr_free(&hMgr));
+}
+
+TEST(Test_ServerTrace, threads_pos)
+{
+    const size_t numThreads = LIB_SERVER_TRACE_THREADS + 2;
+    std::vector<std::thread> threads;
+    std::vector<size_t> perThread(LIB_SERVER_TRACE_THREADS, 0);
+
+    // This thread has a ring now, but the reset takes it back
+    HandleMgr_validate(NULL, NULL);
+    ServerTrace_reset();
+
+    // Each thread gets its own ring, until the pool runs out
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back([]
+        {
+            HandleMgr_t hMgr;
+            HandleMgr_Handle_t buffer[NUM_HANDLES];
+
+            HandleMgr_init(&hMgr, buffer, sizeof(buffer), NULL);
+            HandleMgr_free(&hMgr);
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    // Rings outlive their threads, so all events which were not dropped can
+    // still be dumped; every thread has its events in its own ring, and the
+    // whole pool is used up
+    for (auto& r : dump())
+    {
+        ASSERT_LT(r.thread, LIB_SERVER_TRACE_THREADS);
+        perThread[r.thread]++;
+    }
+    for (auto n : perThread)
+    {
+        ASSERT_EQ(2, n);
+    }
+    ASSERT_EQ(2 * (numThreads - LIB_SERVER_TRACE_THREADS),
+              ServerTrace_getDropped());
+
+    // Once reset, the pool is available again
+    ServerTrace_reset();
+    HandleMgr_validate(NULL, NULL);
+    ASSERT_EQ(1, dump().size());
+    ASSERT_EQ(0, ServerTrace_getDropped());
+    ServerTrace_reset();
+}
+
+#else
+
+TEST(Test_ServerTrace, disabled_pos)
+{
+    size_t calls = 0;
+
+    // Without tracing, the macros must not even evaluate their arguments
+    ServerTrace_BEGIN(t);
+    ServerTrace_END(t, ServerTrace_HANDLEMGR_ADD, &calls, calls++, calls++);
+    ASSERT_EQ(0, calls);
+}
+
+#endif
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+extern "C"
+{
+#include "lib_server/SessionMgr.h"
+}
+
+class Test_SessionMgr : public testing::Test
+{
+    protected:
+};
+
+// Dummy context struct
+typedef struct
+{
+    ContextMgr_CID_t cid;
+} ClientCtx_t;
+
+// Keep track of alloc/free
+static size_t initNum = 0;
+static size_t freeNum = 0;
+
+// Private functions -----------------------------------------------------------
+
+static OS_Error_t
+initClient(
+    const ContextMgr_CID_t cid,
+    void**                 mem)
+{
+    ClientCtx_t* p;
+
+    p = (ClientCtx_t*) calloc(1, sizeof(ClientCtx_t));
+    assert(p != NULL);
+    p->cid = cid;
+
+    *mem = p;
+
+    initNum++;
+
+    return OS_SUCCESS;
+}
+
+static OS_Error_t
+freeClient(
+    const ContextMgr_CID_t cid,
+    void*                  mem)
+{
+    (void) cid;
+
+    free(mem);
+
+    freeNum++;
+
+    return OS_SUCCESS;
+}
+
+const ContextMgr_MemoryFuncs_t fns =
+{
+    .init = initClient,
+    .free = freeClient
+};
+
+#define MAX_CLIENTS 8
+#define MAX_HANDLES 4
+
+// Test functions --------------------------------------------------------------
+
+TEST(Test_SessionMgr, init_free_pos)
+{
+    SessionMgr_t sMgr;
+
+    initNum = freeNum = 0;
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_init(&sMgr, &fns, MAX_CLIENTS,
+                                          MAX_HANDLES));
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_free(&sMgr));
+
+    // We should not have any allocations without calls to get()
+    ASSERT_EQ(initNum, 0);
+    ASSERT_EQ(freeNum, 0);
+}
+
+TEST(Test_SessionMgr, init_neg)
+{
+    SessionMgr_t sMgr;
+    ContextMgr_MemoryFuncs_t myFns;
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(NULL, &fns, MAX_CLIENTS, MAX_HANDLES));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(&sMgr, NULL, MAX_CLIENTS, MAX_HANDLES));
+
+    // Empty callbacks
+    myFns = fns;
+    myFns.free = NULL;
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(&sMgr, &myFns, MAX_CLIENTS, MAX_HANDLES));
+    myFns = fns;
+    myFns.init = NULL;
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(&sMgr, &myFns, MAX_CLIENTS, MAX_HANDLES));
+
+    // Invalid number of clients or handles
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(&sMgr, &fns, 0, MAX_HANDLES));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(&sMgr, &fns, 1025, MAX_HANDLES));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(&sMgr, &fns, MAX_CLIENTS, 0));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_init(&sMgr, &fns, MAX_CLIENTS, 1025));
+}
+
+TEST(Test_SessionMgr, free_neg)
+{
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SessionMgr_free(NULL));
+}
+
+TEST(Test_SessionMgr, get_pos)
+{
+    SessionMgr_t sMgr;
+    ClientCtx_t* ctx;
+
+    initNum = freeNum = 0;
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_init(&sMgr, &fns, MAX_CLIENTS,
+                                          MAX_HANDLES));
+
+    // Get all contexts, this should allocate them
+    for (size_t i = 0; i < MAX_CLIENTS; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS, SessionMgr_get(&sMgr, i, (void**)&ctx));
+        ASSERT_EQ(ctx->cid, i);
+    }
+    ASSERT_EQ(initNum, MAX_CLIENTS);
+
+    // Get contexts again, there should be no further allocation
+    for (size_t i = 0; i < MAX_CLIENTS; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS, SessionMgr_get(&sMgr, i, (void**)&ctx));
+        ASSERT_EQ(ctx->cid, i);
+    }
+    ASSERT_EQ(initNum, MAX_CLIENTS);
+
+    // Free mgr instance and check all contexts were free'd as well
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_free(&sMgr));
+    ASSERT_EQ(freeNum, MAX_CLIENTS);
+}
+
+TEST(Test_SessionMgr, get_neg)
+{
+    SessionMgr_t sMgr;
+    ClientCtx_t* ctx;
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_init(&sMgr, &fns, 2, MAX_HANDLES));
+
+    // Try empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SessionMgr_get(NULL,  0, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SessionMgr_get(&sMgr, 0, NULL));
+
+    // Try to get more contexts than allowed
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_get(&sMgr, 0, (void**)&ctx));
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_get(&sMgr, 1, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              SessionMgr_get(&sMgr, 2, (void**)&ctx));
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_free(&sMgr));
+}
+
+TEST(Test_SessionMgr, resolve_pos)
+{
+    SessionMgr_t sMgr;
+    ClientCtx_t* ctx;
+
+    initNum = 0;
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_init(&sMgr, &fns, MAX_CLIENTS,
+                                          MAX_HANDLES));
+
+    // Adding a handle allocates the context
+    for (size_t i = 0; i < MAX_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  SessionMgr_addHandle(&sMgr, 1, (HandleMgr_Handle_t) (i + 1)));
+        ASSERT_EQ(OS_SUCCESS,
+                  SessionMgr_addHandle(&sMgr, 2, (HandleMgr_Handle_t) (i + 1)));
+    }
+    ASSERT_EQ(initNum, 2);
+
+    for (size_t i = 0; i < MAX_HANDLES; i++)
+    {
+        ctx = NULL;
+        ASSERT_EQ(OS_SUCCESS,
+                  SessionMgr_resolve(&sMgr, 1, (HandleMgr_Handle_t) (i + 1),
+                                     (void**)&ctx));
+        ASSERT_EQ(ctx->cid, 1);
+        ASSERT_EQ(OS_SUCCESS,
+                  SessionMgr_resolve(&sMgr, 2, (HandleMgr_Handle_t) (i + 1),
+                                     (void**)&ctx));
+        ASSERT_EQ(ctx->cid, 2);
+    }
+
+    // Removing a handle from one client leaves the other untouched
+    ASSERT_EQ(OS_SUCCESS,
+              SessionMgr_removeHandle(&sMgr, 1, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              SessionMgr_resolve(&sMgr, 1, (HandleMgr_Handle_t) 1,
+                                 (void**)&ctx));
+    ASSERT_EQ(OS_SUCCESS,
+              SessionMgr_resolve(&sMgr, 2, (HandleMgr_Handle_t) 1,
+                                 (void**)&ctx));
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_free(&sMgr));
+}
+
+TEST(Test_SessionMgr, resolve_neg)
+{
+    SessionMgr_t sMgr;
+    ClientCtx_t* ctx;
+    HandleMgr_Handle_t h = (HandleMgr_Handle_t) 1;
+
+    initNum = 0;
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_init(&sMgr, &fns, MAX_CLIENTS,
+                                          MAX_HANDLES));
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_addHandle(NULL, 0, h));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_addHandle(&sMgr, 0, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_removeHandle(NULL, 0, h));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_removeHandle(&sMgr, 0, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_resolve(NULL, 0, h, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_resolve(&sMgr, 0, NULL, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_resolve(&sMgr, 0, h, NULL));
+
+    // Unknown client neither resolves nor gets allocated
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              SessionMgr_resolve(&sMgr, 0, h, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              SessionMgr_removeHandle(&sMgr, 0, h));
+    ASSERT_EQ(initNum, 0);
+
+    // Duplicates and too many handles
+    for (size_t i = 0; i < MAX_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  SessionMgr_addHandle(&sMgr, 0, (HandleMgr_Handle_t) (i + 1)));
+    }
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED, SessionMgr_addHandle(&sMgr, 0, h));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              SessionMgr_addHandle(&sMgr, 0,
+                                   (HandleMgr_Handle_t) (MAX_HANDLES + 1)));
+
+    // Handle of another client
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_get(&sMgr, 1, (void**)&ctx));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              SessionMgr_resolve(&sMgr, 1, h, (void**)&ctx));
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_free(&sMgr));
+}
+
+TEST(Test_SessionMgr, setQuota_pos)
+{
+    SessionMgr_t sMgr;
+    size_t count;
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_init(&sMgr, &fns, MAX_CLIENTS,
+                                          MAX_HANDLES));
+
+    // Client without context has no handles
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_getCount(&sMgr, 0, &count));
+    ASSERT_EQ(count, 0);
+
+    // Limit client to a single handle, the other one gets the default
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_setQuota(&sMgr, 0, 1));
+    ASSERT_EQ(OS_SUCCESS,
+              SessionMgr_addHandle(&sMgr, 0, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              SessionMgr_addHandle(&sMgr, 0, (HandleMgr_Handle_t) 2));
+    for (size_t i = 0; i < MAX_HANDLES; i++)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  SessionMgr_addHandle(&sMgr, 1, (HandleMgr_Handle_t) (i + 1)));
+    }
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_getCount(&sMgr, 0, &count));
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_getCount(&sMgr, 1, &count));
+    ASSERT_EQ(count, MAX_HANDLES);
+
+    // Lowering the quota keeps the handles but blocks adding new ones
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_setQuota(&sMgr, 1, 2));
+    ASSERT_EQ(OS_SUCCESS,
+              SessionMgr_removeHandle(&sMgr, 1, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              SessionMgr_addHandle(&sMgr, 1, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_getCount(&sMgr, 1, &count));
+    ASSERT_EQ(count, MAX_HANDLES - 1);
+
+    // Failed operations do not change the count
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              SessionMgr_removeHandle(&sMgr, 1, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_setQuota(&sMgr, 1, MAX_HANDLES));
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED,
+              SessionMgr_addHandle(&sMgr, 1, (HandleMgr_Handle_t) 2));
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_getCount(&sMgr, 1, &count));
+    ASSERT_EQ(count, MAX_HANDLES - 1);
+
+    // A quota of zero locks the client out
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_setQuota(&sMgr, 2, 0));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              SessionMgr_addHandle(&sMgr, 2, (HandleMgr_Handle_t) 1));
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_free(&sMgr));
+}
+
+TEST(Test_SessionMgr, setQuota_neg)
+{
+    SessionMgr_t sMgr;
+    size_t count;
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_init(&sMgr, &fns, 1, MAX_HANDLES));
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SessionMgr_setQuota(NULL, 0, 1));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SessionMgr_getCount(NULL, 0, &count));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SessionMgr_getCount(&sMgr, 0, NULL));
+
+    // Quota larger than what was reserved for the client
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SessionMgr_setQuota(&sMgr, 0, MAX_HANDLES + 1));
+
+    // No more slots for further clients
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_setQuota(&sMgr, 0, 1));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE, SessionMgr_setQuota(&sMgr, 1, 1));
+
+    ASSERT_EQ(OS_SUCCESS, SessionMgr_free(&sMgr));
+}
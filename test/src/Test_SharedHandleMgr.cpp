@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2020-2024, HENSOLDT Cyber GmbH
+ * 
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * For commercial licensing, contact: info.cyber@hensoldt.net
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include "lib_server/SharedHandleMgr.h"
+}
+
+class Test_SharedHandleMgr : public testing::Test
+{
+    protected:
+};
+
+#define NUM_HANDLES 10
+
+static size_t numYields;
+
+// Sleep instead of a plain yield, so a preempted writer gets to run even if
+// there is only a single CPU
+static void
+yieldThread(void)
+{
+    numYields++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+// Region which is mapped twice at different addresses, as a stand-in for a
+// dataport mapped into two components
+struct SharedRegion
+{
+    SharedRegion(
+        size_t size) : size(size)
+    {
+        int fd = memfd_create("Test_SharedHandleMgr", 0);
+
+        if (fd >= 0 && ftruncate(fd, size) == 0)
+        {
+            writer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            reader = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    ~SharedRegion()
+    {
+        if (writer != MAP_FAILED)
+        {
+            munmap(writer, size);
+        }
+        if (reader != MAP_FAILED)
+        {
+            munmap(reader, size);
+        }
+    }
+
+    bool
+    isMapped() const
+    {
+        return (writer != MAP_FAILED) && (reader != MAP_FAILED);
+    }
+
+    size_t size;
+    void* writer = MAP_FAILED;
+    void* reader = MAP_FAILED;
+};
+
+// Test functions --------------------------------------------------------------
+
+TEST(Test_SharedHandleMgr, init_free_pos)
+{
+    SharedHandleMgr_t hMgr;
+    uint64_t region[SharedHandleMgr_SIZE_OF_REGION(NUM_HANDLES) /
+                    sizeof(uint64_t)];
+    size_t numEl = NUM_HANDLES - 1;
+
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_init(&hMgr, region, sizeof(region), &numEl));
+    ASSERT_EQ(numEl, NUM_HANDLES);
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&hMgr));
+
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_init(&hMgr, region, sizeof(region), NULL));
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&hMgr));
+}
+
+TEST(Test_SharedHandleMgr, init_neg)
+{
+    SharedHandleMgr_t hMgr;
+    uint64_t region[SharedHandleMgr_SIZE_OF_REGION(NUM_HANDLES) /
+                    sizeof(uint64_t)];
+    size_t numEl = NUM_HANDLES + 1;
+
+    // Empty pointers, misaligned or too small region
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SharedHandleMgr_init(NULL, region, sizeof(region), NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SharedHandleMgr_init(&hMgr, NULL, sizeof(region), NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SharedHandleMgr_init(&hMgr, (uint8_t*) region + 1,
+                                   sizeof(region) - 1, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SharedHandleMgr_init(&hMgr, region,
+                                   sizeof(SharedHandleMgr_Region_t), NULL));
+
+    // Not enough room for the requested handles
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              SharedHandleMgr_init(&hMgr, region, sizeof(region), &numEl));
+}
+
+TEST(Test_SharedHandleMgr, attach_neg)
+{
+    SharedHandleMgr_t writer, reader;
+    uint64_t region[SharedHandleMgr_SIZE_OF_REGION(NUM_HANDLES) /
+                    sizeof(uint64_t)] = { 0 };
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SharedHandleMgr_attach(NULL, region, sizeof(region), NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SharedHandleMgr_attach(&reader, NULL, sizeof(region), NULL));
+
+    // Region was not initialized
+    ASSERT_EQ(OS_ERROR_INVALID_STATE,
+              SharedHandleMgr_attach(&reader, region, sizeof(region), NULL));
+
+    // Region is larger than what the reader has mapped
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_init(&writer, region, sizeof(region), NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_STATE,
+              SharedHandleMgr_attach(&reader, region, sizeof(region) - 8,
+                                     NULL));
+
+    // Writer corrupted the layout
+    ((SharedHandleMgr_Region_t*) region)->handlesOffset = sizeof(region);
+    ASSERT_EQ(OS_ERROR_INVALID_STATE,
+              SharedHandleMgr_attach(&reader, region, sizeof(region), NULL));
+
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&writer));
+}
+
+TEST(Test_SharedHandleMgr, add_remove_pos)
+{
+    SharedHandleMgr_t writer, reader;
+    SharedRegion shm(SharedHandleMgr_SIZE_OF_REGION(NUM_HANDLES));
+
+    ASSERT_TRUE(shm.isMapped());
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_init(&writer, shm.writer, shm.size, NULL));
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_attach(&reader, shm.reader, shm.size, NULL));
+
+    // Handles added by the writer are seen through the other mapping
+    for (size_t i = NUM_HANDLES; i > 0; i--)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  SharedHandleMgr_add(&writer, (HandleMgr_Handle_t) i));
+    }
+    for (uintptr_t i = 1; i <= NUM_HANDLES; i++)
+    {
+        ASSERT_EQ((void*) i,
+                  SharedHandleMgr_validate(&reader, (HandleMgr_Handle_t) i));
+        ASSERT_EQ((void*) i,
+                  SharedHandleMgr_validate(&writer, (HandleMgr_Handle_t) i));
+    }
+    ASSERT_EQ(NULL, SharedHandleMgr_validate(&reader,
+                                             (HandleMgr_Handle_t) 11));
+
+    // So are removed ones
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_remove(&writer,
+                                                 (HandleMgr_Handle_t) 5));
+    ASSERT_EQ(NULL, SharedHandleMgr_validate(&reader,
+                                             (HandleMgr_Handle_t) 5));
+    ASSERT_EQ((void*) 6, SharedHandleMgr_validate(&reader,
+                                                  (HandleMgr_Handle_t) 6));
+
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&reader));
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&writer));
+}
+
+TEST(Test_SharedHandleMgr, add_remove_neg)
+{
+    SharedHandleMgr_t writer, reader;
+    SharedRegion shm(SharedHandleMgr_SIZE_OF_REGION(1));
+    HandleMgr_Handle_t h = (HandleMgr_Handle_t) 1;
+
+    ASSERT_TRUE(shm.isMapped());
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_init(&writer, shm.writer, shm.size, NULL));
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_attach(&reader, shm.reader, shm.size, NULL));
+
+    // Empty pointers
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SharedHandleMgr_add(NULL, h));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SharedHandleMgr_add(&writer, NULL));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER, SharedHandleMgr_remove(NULL, h));
+    ASSERT_EQ(OS_ERROR_INVALID_PARAMETER,
+              SharedHandleMgr_remove(&writer, NULL));
+    ASSERT_EQ(NULL, SharedHandleMgr_validate(NULL, h));
+    ASSERT_EQ(NULL, SharedHandleMgr_validate(&reader, NULL));
+
+    // Readers can't change anything
+    ASSERT_EQ(OS_ERROR_INVALID_STATE, SharedHandleMgr_add(&reader, h));
+    ASSERT_EQ(OS_ERROR_INVALID_STATE, SharedHandleMgr_remove(&reader, h));
+
+    // Duplicate, full, unknown
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_add(&writer, h));
+    ASSERT_EQ(OS_ERROR_OPERATION_DENIED, SharedHandleMgr_add(&writer, h));
+    ASSERT_EQ(OS_ERROR_INSUFFICIENT_SPACE,
+              SharedHandleMgr_add(&writer, (HandleMgr_Handle_t) 2));
+    ASSERT_EQ(OS_ERROR_INVALID_HANDLE,
+              SharedHandleMgr_remove(&writer, (HandleMgr_Handle_t) 2));
+
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&reader));
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&writer));
+}
+
+TEST(Test_SharedHandleMgr, validate_concurrent)
+{
+    const size_t numHandles = 256;
+    SharedHandleMgr_t writer, reader;
+    SharedRegion shm(SharedHandleMgr_SIZE_OF_REGION(numHandles));
+    std::atomic<bool> done(false);
+    size_t falsePositives = 0, falseNegatives = 0;
+
+    ASSERT_TRUE(shm.isMapped());
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_init(&writer, shm.writer, shm.size, NULL));
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_attach(&reader, shm.reader, shm.size,
+                                     yieldThread));
+
+    // Even handles stay, odd ones come and go
+    for (uintptr_t i = 2; i <= numHandles; i += 2)
+    {
+        ASSERT_EQ(OS_SUCCESS,
+                  SharedHandleMgr_add(&writer, (HandleMgr_Handle_t) i));
+    }
+
+    std::thread t([&]
+    {
+        for (size_t n = 0; n < 200; n++)
+        {
+            for (uintptr_t i = 1; i < numHandles; i += 2)
+            {
+                SharedHandleMgr_add(&writer, (HandleMgr_Handle_t) i);
+            }
+            for (uintptr_t i = 1; i < numHandles; i += 2)
+            {
+                SharedHandleMgr_remove(&writer, (HandleMgr_Handle_t) i);
+            }
+        }
+        done = true;
+    });
+
+    // Handles which were never added must never be accepted, and handles
+    // which are always there must never be rejected, no matter how the lookup
+    // interleaves with the writer
+    while (!done)
+    {
+        for (uintptr_t i = numHandles + 1; i < 2 * numHandles; i++)
+        {
+            falsePositives += (SharedHandleMgr_validate(
+                                   &reader, (HandleMgr_Handle_t) i) != NULL);
+        }
+        for (uintptr_t i = 2; i <= numHandles; i += 2)
+        {
+            falseNegatives += (SharedHandleMgr_validate(
+                                   &reader, (HandleMgr_Handle_t) i) == NULL);
+        }
+    }
+    t.join();
+    ASSERT_EQ(0, falsePositives);
+    ASSERT_EQ(0, falseNegatives);
+
+    // Once the writer is done, the reader sees the final state
+    for (uintptr_t i = 1; i <= numHandles; i++)
+    {
+        ASSERT_EQ((i % 2) ? NULL : (void*) i,
+                  SharedHandleMgr_validate(&reader, (HandleMgr_Handle_t) i));
+    }
+
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&reader));
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&writer));
+}
+
+TEST(Test_SharedHandleMgr, validate_stuck_writer)
+{
+    SharedHandleMgr_t writer, reader;
+    SharedRegion shm(SharedHandleMgr_SIZE_OF_REGION(NUM_HANDLES));
+    SharedHandleMgr_Region_t* region;
+
+    ASSERT_TRUE(shm.isMapped());
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_init(&writer, shm.writer, shm.size, NULL));
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_attach(&reader, shm.reader, shm.size,
+                                     yieldThread));
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_add(&writer, (HandleMgr_Handle_t) 1));
+
+    // Pretend the writer got stuck in the middle of an update
+    region = (SharedHandleMgr_Region_t*) shm.writer;
+    region->seq++;
+
+    // The first lookup waits a bounded time for the writer, later ones see it
+    // is still the same update and fail right away
+    numYields = 0;
+    ASSERT_EQ(NULL, SharedHandleMgr_validate(&reader, (HandleMgr_Handle_t) 1));
+    ASSERT_LT(0, numYields);
+    numYields = 0;
+    ASSERT_EQ(NULL, SharedHandleMgr_validate(&reader, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(0, numYields);
+
+    // Once the writer is done, lookups work again
+    region->seq++;
+    ASSERT_EQ((void*) 1,
+              SharedHandleMgr_validate(&reader, (HandleMgr_Handle_t) 1));
+
+    // Without a yield function, a reader only spins
+    ASSERT_EQ(OS_SUCCESS,
+              SharedHandleMgr_attach(&reader, shm.reader, shm.size, NULL));
+    region->seq++;
+    numYields = 0;
+    ASSERT_EQ(NULL, SharedHandleMgr_validate(&reader, (HandleMgr_Handle_t) 1));
+    ASSERT_EQ(0, numYields);
+    region->seq++;
+
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&reader));
+    ASSERT_EQ(OS_SUCCESS, SharedHandleMgr_free(&writer));
+}